@@ -40,6 +40,10 @@
 #include "okapi/api/chassis/controller/chassisScales.hpp"
 #include "okapi/api/chassis/controller/defaultOdomChassisController.hpp"
 #include "okapi/api/chassis/controller/odomChassisController.hpp"
+#include "okapi/api/chassis/controller/odomCommandQueue.hpp"
+#include "okapi/api/chassis/controller/profiledChassisControllerPid.hpp"
+#include "okapi/api/chassis/controller/purePursuitFollower.hpp"
+#include "okapi/api/chassis/controller/steppedChassisControllerPid.hpp"
 #include "okapi/api/chassis/model/hDriveModel.hpp"
 #include "okapi/api/chassis/model/readOnlyChassisModel.hpp"
 #include "okapi/api/chassis/model/skidSteerModel.hpp"
@@ -47,6 +51,7 @@
 #include "okapi/api/chassis/model/threeEncoderXDriveModel.hpp"
 #include "okapi/api/chassis/model/xDriveModel.hpp"
 #include "okapi/impl/chassis/controller/chassisControllerBuilder.hpp"
+#include "okapi/impl/chassis/controller/eventChassisControllerPid.hpp"
 
 #include "okapi/api/control/async/asyncLinearMotionProfileController.hpp"
 #include "okapi/api/control/async/asyncMotionProfileController.hpp"
@@ -57,31 +62,44 @@
 #include "okapi/api/control/async/asyncWrapper.hpp"
 #include "okapi/api/control/controllerInput.hpp"
 #include "okapi/api/control/controllerOutput.hpp"
+#include "okapi/api/control/iterative/gainScheduledPosPidController.hpp"
 #include "okapi/api/control/iterative/iterativeMotorVelocityController.hpp"
 #include "okapi/api/control/iterative/iterativePosPidController.hpp"
 #include "okapi/api/control/iterative/iterativeVelPidController.hpp"
 #include "okapi/api/control/util/controllerRunner.hpp"
 #include "okapi/api/control/util/flywheelSimulator.hpp"
+#include "okapi/api/control/util/motionProfile.hpp"
 #include "okapi/api/control/util/pidTuner.hpp"
+#include "okapi/api/control/util/predictiveSettledUtil.hpp"
+#include "okapi/api/control/util/relayAutotuner.hpp"
 #include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/simulatedPidTuner.hpp"
 #include "okapi/impl/control/async/asyncMotionProfileControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncPosControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncVelControllerBuilder.hpp"
 #include "okapi/impl/control/iterative/iterativeControllerFactory.hpp"
+#include "okapi/impl/control/util/controlExecutor.hpp"
 #include "okapi/impl/control/util/controllerRunnerFactory.hpp"
 #include "okapi/impl/control/util/pidTunerFactory.hpp"
 
+#include "okapi/api/odometry/fusedOdometry.hpp"
 #include "okapi/api/odometry/odomMath.hpp"
+#include "okapi/api/odometry/odomStateHistory.hpp"
 #include "okapi/api/odometry/odometry.hpp"
 #include "okapi/api/odometry/threeEncoderOdometry.hpp"
+#include "okapi/api/odometry/timestampedOdometry.hpp"
+#include "okapi/impl/odometry/odometryTask.hpp"
 
+#include "okapi/api/device/absolutePositionSensor.hpp"
 #include "okapi/api/device/rotarysensor/continuousRotarySensor.hpp"
 #include "okapi/api/device/rotarysensor/rotarySensor.hpp"
+#include "okapi/api/device/rotarysensor/timestampedRotarySensor.hpp"
 #include "okapi/impl/device/adiUltrasonic.hpp"
 #include "okapi/impl/device/button/adiButton.hpp"
 #include "okapi/impl/device/button/controllerButton.hpp"
 #include "okapi/impl/device/controller.hpp"
 #include "okapi/impl/device/distanceSensor.hpp"
+#include "okapi/impl/device/gpsPositionSensor.hpp"
 #include "okapi/impl/device/motor/adiMotor.hpp"
 #include "okapi/impl/device/motor/motor.hpp"
 #include "okapi/impl/device/motor/motorGroup.hpp"
@@ -92,6 +110,8 @@
 #include "okapi/impl/device/rotarysensor/integratedEncoder.hpp"
 #include "okapi/impl/device/rotarysensor/potentiometer.hpp"
 #include "okapi/impl/device/rotarysensor/rotationSensor.hpp"
+#include "okapi/impl/device/rotarysensor/timestampedIntegratedEncoder.hpp"
+#include "okapi/impl/device/rotarysensor/timestampedRotationSensor.hpp"
 
 #include "okapi/api/filter/averageFilter.hpp"
 #include "okapi/api/filter/composableFilter.hpp"
@@ -99,9 +119,14 @@
 #include "okapi/api/filter/ekfFilter.hpp"
 #include "okapi/api/filter/emaFilter.hpp"
 #include "okapi/api/filter/filter.hpp"
+#include "okapi/api/filter/filterBank.hpp"
+#include "okapi/api/filter/filterPipeline.hpp"
 #include "okapi/api/filter/filteredControllerInput.hpp"
+#include "okapi/api/filter/kalmanFilter.hpp"
 #include "okapi/api/filter/medianFilter.hpp"
 #include "okapi/api/filter/passthroughFilter.hpp"
+#include "okapi/api/filter/runningMedianFilter.hpp"
+#include "okapi/api/filter/timestampedVelMath.hpp"
 #include "okapi/api/filter/velMath.hpp"
 #include "okapi/impl/filter/velMathFactory.hpp"
 
@@ -125,10 +150,21 @@
 
 #include "okapi/api/util/abstractRate.hpp"
 #include "okapi/api/util/abstractTimer.hpp"
+#include "okapi/api/util/allocationCounter.hpp"
+#include "okapi/api/util/arena.hpp"
+#include "okapi/api/util/fixedString.hpp"
+#include "okapi/api/util/mailbox.hpp"
 #include "okapi/api/util/mathUtil.hpp"
+#include "okapi/api/util/seqlock.hpp"
 #include "okapi/api/util/supplier.hpp"
 #include "okapi/api/util/timeUtil.hpp"
 #include "okapi/impl/util/configurableTimeUtilFactory.hpp"
+#include "okapi/impl/util/messageQueue.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include "okapi/impl/util/periodicTaskSet.hpp"
+#include "okapi/impl/util/predictiveTimeUtilFactory.hpp"
 #include "okapi/impl/util/rate.hpp"
+#include "okapi/impl/util/taskMonitor.hpp"
+#include "okapi/impl/util/taskWatchdog.hpp"
 #include "okapi/impl/util/timeUtilFactory.hpp"
 #include "okapi/impl/util/timer.hpp"
@@ -0,0 +1,191 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/odomChassisController.hpp"
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/odometry/point.hpp"
+#include "okapi/api/odometry/stateMode.hpp"
+#include "okapi/api/units/QAngle.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace okapi {
+class OdomCommandQueue {
+  public:
+  /**
+   * A queue of point-to-point movements which runs in its own task, ahead of the caller. Unlike
+   * OdomChassisController::driveToPoint, a movement does not settle before the next one starts:
+   * once the robot is inside a movement's exit radius and another movement is queued, the queue
+   * switches targets without stopping, so consecutive movements blend into one path. Only the last
+   * queued movement is settled.
+   *
+   * Each movement steers towards its target continuously. The distance controller is stepped with
+   * the remaining distance in meters projected onto the robot's heading, and the angle and turn
+   * controllers are stepped with the heading error in degrees, so their gains must be tuned in
+   * those units. The queue sets the controllers' targets to zero at the start of a movement. At a
+   * hand-over between blended drives it shifts the drive controllers' targets and readings by the
+   * same amount instead, so their errors are unchanged and their state carries over.
+   *
+   * The queue drives the model of icontroller directly. Do not issue movements on icontroller while
+   * the queue is busy.
+   *
+   * @param itimeUtil The TimeUtil.
+   * @param icontroller The odometry chassis controller to read the state from and drive.
+   * @param idistanceController The forward controller.
+   * @param iangleController The heading controller used while driving.
+   * @param iturnController The heading controller used while turning in place.
+   * @param iexitRadius The default distance from a target at which to start the next movement.
+   * @param iexitAngle The heading error at which a turn hands over to the next movement.
+   * @param isteerRadius The distance from the final target inside which steering is disabled,
+   * because the heading to a point becomes unstable as the robot reaches it.
+   * @param imode The state mode targets are given in.
+   * @param ilogger The logger this instance will log to.
+   */
+  OdomCommandQueue(const TimeUtil &itimeUtil,
+                   std::shared_ptr<OdomChassisController> icontroller,
+                   std::unique_ptr<IterativePosPIDController> idistanceController,
+                   std::unique_ptr<IterativePosPIDController> iangleController,
+                   std::unique_ptr<IterativePosPIDController> iturnController,
+                   const QLength &iexitRadius = 6_in,
+                   const QAngle &iexitAngle = 10_deg,
+                   const QLength &isteerRadius = 2_in,
+                   const StateMode &imode = StateMode::FRAME_TRANSFORMATION,
+                   std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  ~OdomCommandQueue();
+
+  OdomCommandQueue(const OdomCommandQueue &) = delete;
+  OdomCommandQueue(OdomCommandQueue &&other) = delete;
+  OdomCommandQueue &operator=(const OdomCommandQueue &other) = delete;
+  OdomCommandQueue &operator=(OdomCommandQueue &&other) = delete;
+
+  /**
+   * Queues a drive to a point using the default exit radius. Returns immediately.
+   *
+   * @param ipoint The target point in the queue's state mode.
+   * @param ibackwards Whether to drive to the point backwards.
+   * @return The id of the movement, to pass to waitUntilDone.
+   */
+  std::uint32_t driveToPoint(const Point &ipoint, bool ibackwards = false);
+
+  /**
+   * Queues a drive to a point. Returns immediately.
+   *
+   * @param ipoint The target point in the queue's state mode.
+   * @param ibackwards Whether to drive to the point backwards.
+   * @param iexitRadius The distance from the point at which to start the next movement.
+   * @return The id of the movement, to pass to waitUntilDone.
+   */
+  std::uint32_t driveToPoint(const Point &ipoint, bool ibackwards, const QLength &iexitRadius);
+
+  /**
+   * Queues a turn in place to face a point. Returns immediately.
+   *
+   * @param ipoint The point to face in the queue's state mode.
+   * @return The id of the movement, to pass to waitUntilDone.
+   */
+  std::uint32_t turnToPoint(const Point &ipoint);
+
+  /**
+   * Queues a turn in place to an absolute heading. Returns immediately.
+   *
+   * @param iangle The heading.
+   * @return The id of the movement, to pass to waitUntilDone.
+   */
+  std::uint32_t turnToAngle(const QAngle &iangle);
+
+  /**
+   * Blocks until the movement with the given id has been left for the next one or has settled.
+   * Returns immediately for an id which was never issued.
+   *
+   * @param iid The id of the movement.
+   */
+  void waitUntilDone(std::uint32_t iid);
+
+  /**
+   * Blocks until every queued movement is done and the last one has settled.
+   */
+  void waitUntilSettled();
+
+  /**
+   * @return Whether every queued movement is done and the last one has settled.
+   */
+  bool isSettled() const;
+
+  /**
+   * @return The number of movements which are queued or running.
+   */
+  std::size_t size();
+
+  /**
+   * Drops every queued movement, ends the current one, and stops the chassis.
+   */
+  void stop();
+
+  /**
+   * Starts the internal thread. This should not be called by normal users.
+   */
+  void startThread();
+
+  protected:
+  enum class CommandType { drive, turnToPoint, turnToAngle };
+
+  struct Command {
+    std::uint32_t id;
+    CommandType type;
+    Point point;
+    QAngle angle;
+    bool backwards;
+    QLength exitRadius;
+  };
+
+  std::shared_ptr<Logger> logger;
+  TimeUtil timeUtil;
+  std::shared_ptr<OdomChassisController> controller;
+  std::unique_ptr<IterativePosPIDController> distancePid;
+  std::unique_ptr<IterativePosPIDController> anglePid;
+  std::unique_ptr<IterativePosPIDController> turnPid;
+  QLength exitRadius;
+  QAngle exitAngle;
+  QLength steerRadius;
+  StateMode mode;
+
+  CrossplatformMutex queueMutex;
+  std::deque<Command> commands;
+  std::uint32_t nextId{1};
+  std::atomic<std::uint32_t> doneId{0};
+  std::atomic_bool idle{true};
+  std::atomic_bool dtorCalled{false};
+  CrossplatformThread *task{nullptr};
+
+  // The drive controllers' targets. Blended drives shift them so the readings stay continuous.
+  double distanceOffset{0};
+  double angleOffset{0};
+
+  std::uint32_t enqueue(Command icommand);
+
+  /**
+   * Steps the controllers for a command and drives the chassis.
+   *
+   * @param icommand The command.
+   * @param ilast Whether no other command is queued after this one.
+   * @param ireseed Whether the command follows a blended drive, so the drive controllers' targets
+   * should be shifted to keep their readings continuous before stepping.
+   * @return Whether the command is done.
+   */
+  bool stepCommand(const Command &icommand, bool ilast, bool ireseed);
+
+  static void trampoline(void *context);
+  void loop();
+};
+} // namespace okapi
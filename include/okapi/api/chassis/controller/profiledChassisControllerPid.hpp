@@ -0,0 +1,157 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/steppedChassisControllerPid.hpp"
+#include "okapi/api/control/util/motionProfile.hpp"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/util/abstractTimer.hpp"
+#include <memory>
+
+namespace okapi {
+struct ChassisProfileLimits {
+  double maxVel;   // Maximum velocity in m/s, or deg/s for turns
+  double maxAccel; // Maximum acceleration in m/s/s, or deg/s/s for turns
+  double kV{0};    // Feedforward output per m/s, or per deg/s
+  double kA{0};    // Feedforward output per m/s/s, or per deg/s/s
+};
+
+class ProfiledChassisControllerPID : public SteppedChassisControllerPID {
+  public:
+  enum class ProfileMode {
+    /**
+     * Set the PID target straight to the final target, like ChassisControllerPID.
+     */
+    step,
+
+    /**
+     * Track a trapezoidal profile to the target.
+     */
+    trapezoidal,
+
+    /**
+     * Track an S-curve profile to the target.
+     */
+    sCurve
+  };
+
+  /**
+   * A ChassisControllerPID which moves its PID setpoint along a motion profile instead of jumping
+   * it to the final target. The PIDs only have to correct the tracking error, so they don't
+   * saturate and overshoot on long movements, and the feedforward terms supply most of the output.
+   * Short movements take a short profile and settle sooner. waitUntilSettled waits for the profile
+   * to finish before waiting for the PIDs to settle.
+   *
+   * Construct it directly and call startThread(). See ChassisControllerPID docs for the other
+   * parameters.
+   *
+   * @param idistanceLimits The limits and feedforward gains for moveDistance.
+   * @param iturnLimits The limits and feedforward gains for turnAngle.
+   * @param imode The profile mode.
+   */
+  ProfiledChassisControllerPID(
+    TimeUtil itimeUtil,
+    std::shared_ptr<ChassisModel> imodel,
+    std::unique_ptr<IterativePosPIDController> idistanceController,
+    std::unique_ptr<IterativePosPIDController> iturnController,
+    std::unique_ptr<IterativePosPIDController> iangleController,
+    const ChassisProfileLimits &idistanceLimits,
+    const ChassisProfileLimits &iturnLimits,
+    ProfileMode imode = ProfileMode::trapezoidal,
+    const AbstractMotor::GearsetRatioPair &igearset = AbstractMotor::gearset::green,
+    const ChassisScales &iscales = ChassisScales({1, 1}, imev5GreenTPR),
+    std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Stops the internal thread before the profile state it uses is destroyed.
+   */
+  ~ProfiledChassisControllerPID() override;
+
+  void moveDistanceAsync(QLength itarget) override;
+
+  void turnAngleAsync(QAngle idegTarget) override;
+
+  bool isSettled() override;
+
+  void waitUntilSettled() override;
+
+  /**
+   * Sets the profile mode. Takes effect on the next movement.
+   *
+   * @param imode The profile mode.
+   */
+  void setProfileMode(ProfileMode imode);
+
+  /**
+   * @return The profile mode.
+   */
+  ProfileMode getProfileMode() const;
+
+  /**
+   * Sets the limits and feedforward gains for moveDistance. Takes effect on the next movement.
+   *
+   * @param ilimits The limits.
+   */
+  void setDistanceLimits(const ChassisProfileLimits &ilimits);
+
+  /**
+   * Sets the limits and feedforward gains for turnAngle. Takes effect on the next movement.
+   *
+   * @param ilimits The limits.
+   */
+  void setTurnLimits(const ChassisProfileLimits &ilimits);
+
+  protected:
+  ChassisProfileLimits distanceLimits;
+  ChassisProfileLimits turnLimits;
+  ProfileMode profileMode;
+  std::unique_ptr<AbstractTimer> timer;
+
+  CrossplatformMutex profileMutex;
+  bool profileActive{false};
+  MotionProfile profile{0, 1, 1};
+  ChassisProfileLimits activeLimits{1, 1};
+  double activeScale{1};
+  QTime profileStart{0_ms};
+
+  /**
+   * Replaces the final target the base class just set with a profile to it. Must be called with
+   * profileMutex held.
+   *
+   * @param ipid The PID the base class set the target of.
+   * @param ilimits The limits to use.
+   * @param iscale The number of encoder units per meter or per degree.
+   */
+  void startProfile(IterativePosPIDController &ipid,
+                    const ChassisProfileLimits &ilimits,
+                    double iscale);
+
+  /**
+   * @return Whether the current profile has finished, or there is none.
+   */
+  bool isProfileDone();
+
+  /**
+   * Steps a PID along the current profile. Must be called with profileMutex held.
+   *
+   * @param ipid The PID.
+   * @param ireading The reading in encoder units.
+   * @return The output, with feedforward.
+   */
+  double stepProfile(IterativePosPIDController &ipid, double ireading);
+
+  /**
+   * Runs one iteration of the movement with profileMutex held. A movement is issued and profiled
+   * under the same lock, so an iteration never mixes the previous movement's encoder start values
+   * with the new profile.
+   */
+  void stepMovement() override;
+
+  double stepDistancePid(double idistanceElapsed) override;
+
+  double stepTurnPid(double iangleChange) override;
+};
+} // namespace okapi
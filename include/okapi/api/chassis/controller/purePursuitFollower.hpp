@@ -0,0 +1,208 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/odomChassisController.hpp"
+#include "okapi/api/odometry/point.hpp"
+#include "okapi/api/odometry/stateMode.hpp"
+#include "okapi/api/units/QAcceleration.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include "squiggles.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace okapi {
+class PurePursuitPath {
+  public:
+  struct Waypoint {
+    /**
+     * The position in meters in the frame transformation state mode.
+     */
+    double x{0};
+    double y{0};
+
+    /**
+     * The distance along the path from the first waypoint in meters.
+     */
+    double distance{0};
+
+    /**
+     * The signed curvature in 1/meters. Positive curves to the right.
+     */
+    double curvature{0};
+
+    /**
+     * The target velocity in meters per second.
+     */
+    double velocity{0};
+  };
+
+  PurePursuitPath() = default;
+
+  /**
+   * Makes a path from a polyline. Extra waypoints are injected so that no two are more than
+   * ispacing apart. The target velocity at each waypoint is limited by imaxVelocity, by
+   * iturnConstant divided by the curvature there, and by imaxAcceleration, so the robot speeds up
+   * from the start, slows down for corners, and slows down for the end of the path.
+   *
+   * @param ipoints The polyline.
+   * @param ispacing The largest distance between waypoints.
+   * @param imaxVelocity The maximum velocity.
+   * @param imaxAcceleration The maximum acceleration.
+   * @param iturnConstant The velocity limit at a curvature of 1/meter, in meters per second. Lower
+   * values slow down more in corners.
+   * @param iminVelocity The minimum target velocity, so the robot starts and reaches the end.
+   * @param imode The state mode the points are given in.
+   */
+  static PurePursuitPath fromPoints(const std::vector<Point> &ipoints,
+                                    const QLength &ispacing,
+                                    const QSpeed &imaxVelocity,
+                                    const QAcceleration &imaxAcceleration,
+                                    double iturnConstant = 2,
+                                    const QSpeed &iminVelocity = 0.1_mps,
+                                    const StateMode &imode = StateMode::FRAME_TRANSFORMATION);
+
+  /**
+   * Makes a path from a squiggles profile, such as one generated for
+   * AsyncMotionProfileController. The profile's poses are read as meters in imode and its
+   * velocities are used as the target velocities, raised to iminVelocity.
+   *
+   * @param iprofile The profile.
+   * @param iminVelocity The minimum target velocity, so the robot starts and reaches the end.
+   * @param imode The state mode the profile's poses are given in.
+   */
+  static PurePursuitPath fromProfile(const std::vector<squiggles::ProfilePoint> &iprofile,
+                                     const QSpeed &iminVelocity = 0.1_mps,
+                                     const StateMode &imode = StateMode::FRAME_TRANSFORMATION);
+
+  /**
+   * @return The waypoints.
+   */
+  const std::vector<Waypoint> &getWaypoints() const;
+
+  /**
+   * @return The length of the path.
+   */
+  QLength getLength() const;
+
+  protected:
+  std::vector<Waypoint> waypoints;
+
+  /**
+   * Fills in each waypoint's distance and curvature from their positions.
+   */
+  void computeGeometry();
+};
+
+class PurePursuitFollower {
+  public:
+  /**
+   * An adaptive pure pursuit path follower. Every step, the robot steers along the arc through
+   * the point where a circle around it crosses the path ahead (the lookahead point), at the target
+   * velocity of the closest waypoint. The circle's radius grows with the target velocity, so the
+   * robot follows tightly when slow and smoothly when fast.
+   *
+   * The closest waypoint and the lookahead point only ever move forward along the path, and each
+   * search starts from where the last one ended, so a step costs O(1) amortized instead of a scan
+   * of the whole path. The lookahead search also stops once it is further along the path than the
+   * lookahead distance can reach, so a path which crosses itself can't make the robot skip ahead.
+   *
+   * The chassis is driven with ChassisModel::left and right in velocity mode, scaled by the
+   * controller's chassis scales, gearset ratio, and max velocity.
+   *
+   * @param itimeUtil The TimeUtil.
+   * @param icontroller The odometry chassis controller to read the state from and drive.
+   * @param ilookaheadTime The lookahead distance per unit of target velocity.
+   * @param iminLookahead The smallest lookahead distance.
+   * @param imaxLookahead The largest lookahead distance.
+   * @param igoalTolerance The distance from the end of the path at which the path is done.
+   * @param ilogger The logger this instance will log to.
+   */
+  PurePursuitFollower(const TimeUtil &itimeUtil,
+                      std::shared_ptr<OdomChassisController> icontroller,
+                      const QTime &ilookaheadTime = 0.5_s,
+                      const QLength &iminLookahead = 6_in,
+                      const QLength &imaxLookahead = 18_in,
+                      const QLength &igoalTolerance = 1_in,
+                      std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Sets the path to follow and restarts from its beginning.
+   *
+   * @param ipath The path.
+   * @param ibackwards Whether to follow the path driving backwards.
+   */
+  void setPath(PurePursuitPath ipath, bool ibackwards = false);
+
+  /**
+   * Runs one iteration of the follower and drives the chassis. Stops the chassis when the path is
+   * done. Use this to run the follower from another loop, such as a ControlExecutor.
+   *
+   * @return Whether the path is done.
+   */
+  bool step();
+
+  /**
+   * Follows a path. Blocks until the path is done or stop() is called.
+   *
+   * @param ipath The path.
+   * @param ibackwards Whether to follow the path driving backwards.
+   */
+  void followPath(PurePursuitPath ipath, bool ibackwards = false);
+
+  /**
+   * @return Whether the path is done.
+   */
+  bool isSettled() const;
+
+  /**
+   * Abandons the path and stops the chassis.
+   */
+  void stop();
+
+  /**
+   * @return The index of the closest waypoint.
+   */
+  std::size_t getClosestIndex() const;
+
+  /**
+   * @return The last lookahead point.
+   */
+  Point getLookaheadPoint() const;
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  TimeUtil timeUtil;
+  std::shared_ptr<OdomChassisController> controller;
+  double lookaheadTime;
+  double minLookahead;
+  double maxLookahead;
+  double goalTolerance;
+
+  PurePursuitPath path;
+  bool backwards{false};
+  std::size_t closestIndex{0};
+  std::size_t lookaheadIndex{0};
+  double lookaheadFraction{0};
+  double lookaheadX{0};
+  double lookaheadY{0};
+  std::atomic_bool done{true};
+
+  /**
+   * Moves the lookahead point forward to the first crossing of the path and a circle.
+   *
+   * @param ix The circle's center x.
+   * @param iy The circle's center y.
+   * @param iradius The circle's radius.
+   */
+  void updateLookahead(double ix, double iy, double iradius);
+};
+} // namespace okapi
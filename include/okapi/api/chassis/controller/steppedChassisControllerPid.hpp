@@ -0,0 +1,102 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/chassisControllerPid.hpp"
+#include "okapi/api/util/abstractRate.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <valarray>
+
+namespace okapi {
+class SteppedChassisControllerPID : public ChassisControllerPID {
+  public:
+  /**
+   * A ChassisControllerPID whose control loop is split into overridable parts, so subclasses can
+   * change how the PIDs are stepped or how the task waits without copying the loop. The loop is
+   * the same as ChassisControllerPID's: while there is a movement, each iteration calls
+   * stepMovement() and then waitStep(); while idle, it calls waitIdle().
+   *
+   * Construct a subclass directly and call startThread(). See ChassisControllerPID docs for the
+   * parameters.
+   *
+   * @param ithreadName The name of the internal thread.
+   */
+  SteppedChassisControllerPID(
+    TimeUtil itimeUtil,
+    std::shared_ptr<ChassisModel> imodel,
+    std::unique_ptr<IterativePosPIDController> idistanceController,
+    std::unique_ptr<IterativePosPIDController> iturnController,
+    std::unique_ptr<IterativePosPIDController> iangleController,
+    const AbstractMotor::GearsetRatioPair &igearset = AbstractMotor::gearset::green,
+    const ChassisScales &iscales = ChassisScales({1, 1}, imev5GreenTPR),
+    std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger(),
+    std::string ithreadName = "SteppedChassisControllerPID");
+
+  /**
+   * Stops and deletes the internal thread.
+   */
+  ~SteppedChassisControllerPID() override;
+
+  /**
+   * Starts the internal thread. Replaces ChassisControllerPID::startThread.
+   */
+  void startThread();
+
+  protected:
+  std::string threadName;
+  std::valarray<std::int32_t> encStartVals;
+  std::valarray<std::int32_t> encVals;
+  modeType pastMode{none};
+
+  /**
+   * Stops and deletes the internal thread. A subclass whose members the thread uses must call this
+   * first in its destructor, so the thread can't run while those members are destroyed.
+   */
+  void stopThread();
+
+  /**
+   * Runs one iteration of the current movement: reads the encoders relative to the start of the
+   * movement, steps the PIDs, and drives the chassis. Called by the internal thread.
+   */
+  virtual void stepMovement();
+
+  /**
+   * Steps the distance PID.
+   *
+   * @param idistanceElapsed The distance driven since the start of the movement, in encoder units.
+   * @return The forward output.
+   */
+  virtual double stepDistancePid(double idistanceElapsed);
+
+  /**
+   * Steps the turn PID.
+   *
+   * @param iangleChange The difference between the sides since the start of the movement, in
+   * encoder units.
+   * @return The turn output.
+   */
+  virtual double stepTurnPid(double iangleChange);
+
+  /**
+   * Waits while there is no movement. Sleeps one period by default.
+   *
+   * @param irate The loop's rate.
+   */
+  virtual void waitIdle(AbstractRate &irate);
+
+  /**
+   * Waits between iterations of a movement. Sleeps until the next period by default.
+   *
+   * @param irate The loop's rate.
+   */
+  virtual void waitStep(AbstractRate &irate);
+
+  static void steppedTrampoline(void *context);
+  void steppedLoop();
+};
+} // namespace okapi
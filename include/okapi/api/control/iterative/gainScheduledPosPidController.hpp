@@ -0,0 +1,79 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/controllerInput.hpp"
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include <memory>
+#include <vector>
+
+namespace okapi {
+/**
+ * A position PID controller whose gains depend on the operating point. The gains are linearly
+ * interpolated, every step, from a table of gains keyed on a scheduling variable: the controller's
+ * own reading (position), or any other input such as velocity or battery voltage. Outside the
+ * table the gains of the nearest end are used.
+ *
+ * With bumpless transfer, a change of kP or kBias is absorbed by the integrator, so the output
+ * does not jump when the gains change. This matters when the scheduling variable is noisy or
+ * the table changes steeply.
+ */
+class GainScheduledPosPIDController : public IterativePosPIDController {
+  public:
+  struct SchedulePoint {
+    double key;
+    Gains gains;
+  };
+
+  /**
+   * Gain-scheduled position PID controller. Throws a `std::invalid_argument` exception if the
+   * schedule is empty.
+   *
+   * @param ischedule The gains at each value of the scheduling variable. Need not be sorted.
+   * @param ischeduleInput The scheduling variable. If nullptr, the controller's reading is used.
+   * @param itimeUtil see TimeUtil docs
+   * @param ibumpless Whether to absorb changes of kP and kBias in the integrator.
+   * @param iderivativeFilter a filter for filtering the derivative term
+   * @param ilogger The logger this instance will log to.
+   */
+  GainScheduledPosPIDController(
+    std::vector<SchedulePoint> ischedule,
+    const std::shared_ptr<ControllerInput<double>> &ischeduleInput,
+    const TimeUtil &itimeUtil,
+    bool ibumpless = true,
+    std::unique_ptr<Filter> iderivativeFilter = std::make_unique<PassthroughFilter>(),
+    std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Schedules the gains, then does one iteration of the controller. Returns the reading in the
+   * range [-1, 1] unless the bounds have been changed with setOutputLimits().
+   *
+   * @param inewReading new measurement
+   * @return controller output
+   */
+  double step(double inewReading) override;
+
+  /**
+   * Interpolates the schedule.
+   *
+   * @param ikey The value of the scheduling variable.
+   * @return The gains at that value.
+   */
+  Gains getScheduledGains(double ikey) const;
+
+  /**
+   * Replaces the schedule. Throws a `std::invalid_argument` exception if it is empty.
+   *
+   * @param ischedule The gains at each value of the scheduling variable. Need not be sorted.
+   */
+  void setSchedule(std::vector<SchedulePoint> ischedule);
+
+  protected:
+  std::vector<SchedulePoint> schedule;
+  std::shared_ptr<ControllerInput<double>> scheduleInput;
+  bool bumpless;
+};
+} // namespace okapi
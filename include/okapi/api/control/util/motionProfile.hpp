@@ -0,0 +1,79 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/units/QTime.hpp"
+
+namespace okapi {
+class MotionProfile {
+  public:
+  enum class Shape {
+    /**
+     * Constant acceleration up to the max velocity, then constant deceleration. The acceleration
+     * steps at the ends of each ramp.
+     */
+    trapezoidal,
+
+    /**
+     * Sinusoidal acceleration ramps, so the acceleration is continuous and the jerk is bounded.
+     * Each ramp takes twice as long as a trapezoidal one with the same peak acceleration.
+     */
+    sCurve
+  };
+
+  struct State {
+    double position{0};
+    double velocity{0};
+    double acceleration{0};
+  };
+
+  /**
+   * A one-dimensional rest-to-rest motion profile. Positions, velocities, and accelerations can be
+   * in any consistent units, such as encoder ticks, ticks per second, and ticks per second squared.
+   * If the distance is too short to reach the max velocity, the profile peaks at a lower velocity
+   * instead.
+   *
+   * @param idistance The signed distance to travel.
+   * @param imaxVelocity The max velocity. Must be greater than zero.
+   * @param imaxAcceleration The max acceleration. Must be greater than zero.
+   * @param ishape The shape of the acceleration ramps.
+   */
+  MotionProfile(double idistance,
+                double imaxVelocity,
+                double imaxAcceleration,
+                Shape ishape = Shape::trapezoidal);
+
+  /**
+   * Samples the profile. Times before the start return the start and times after the end return
+   * the end.
+   *
+   * @param itime The time since the start of the profile.
+   * @return The setpoint at that time.
+   */
+  State get(QTime itime) const;
+
+  /**
+   * @return The time the profile takes.
+   */
+  QTime getDuration() const;
+
+  protected:
+  Shape shape;
+  double direction;
+  double distance;
+  double cruiseVelocity;
+  double rampTime;
+  double cruiseTime;
+
+  /**
+   * Samples an acceleration ramp from rest to the cruise velocity.
+   *
+   * @param itime The time since the start of the ramp.
+   * @return The ramp's setpoint, in the positive direction.
+   */
+  State ramp(double itime) const;
+};
+} // namespace okapi
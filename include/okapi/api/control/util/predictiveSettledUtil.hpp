@@ -0,0 +1,84 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/settledUtil.hpp"
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+class PredictiveSettledUtil : public SettledUtil {
+  public:
+  /**
+   * A SettledUtil which also declares the loop settled early when the error is decaying
+   * predictably. An exponential decay is fit to the most recent errors (a line through their
+   * logarithms). If the fit is good, the error has not changed sign, and the error it predicts
+   * after `ipredictionHorizon` is within `iatTargetError`, the loop is settled without waiting
+   * out `iatTargetTime`. Otherwise it falls back to the SettledUtil rules, so it is never slower.
+   *
+   * @param iatTargetTimer A timer used to track `iatTargetTime` and to timestamp errors.
+   * @param iatTargetError The minimum error to be considered settled.
+   * @param iatTargetDerivative The minimum error derivative to be considered settled.
+   * @param iatTargetTime The minimum time within atTargetError to be considered settled.
+   * @param ipredictionHorizon How far ahead the error is predicted.
+   * @param icaptureError The error must be within this before a prediction is trusted. Defaults
+   * to three times `iatTargetError` when zero.
+   * @param ifitSamples The number of errors the decay is fit to, at most maxFitSamples.
+   * @param iminFitQuality The minimum coefficient of determination (R^2) of the fit.
+   */
+  explicit PredictiveSettledUtil(std::unique_ptr<AbstractTimer> iatTargetTimer,
+                                 double iatTargetError = 50,
+                                 double iatTargetDerivative = 5,
+                                 QTime iatTargetTime = 250_ms,
+                                 QTime ipredictionHorizon = 100_ms,
+                                 double icaptureError = 0,
+                                 std::size_t ifitSamples = 6,
+                                 double iminFitQuality = 0.95);
+
+  ~PredictiveSettledUtil() override;
+
+  /**
+   * Returns whether the controller is settled.
+   *
+   * @param ierror The current error.
+   * @return Whether the controller is settled.
+   */
+  bool isSettled(double ierror) override;
+
+  /**
+   * Resets the "at target" timer and clears the error history.
+   */
+  void reset() override;
+
+  /**
+   * @return The decay rate (1/s) of the last good fit, or zero if there was none.
+   */
+  double getDecayRate() const;
+
+  static constexpr std::size_t maxFitSamples = 16;
+
+  protected:
+  QTime predictionHorizon;
+  double captureError;
+  std::size_t fitSamples;
+  double minFitQuality;
+
+  std::array<double, maxFitSamples> times{};
+  std::array<double, maxFitSamples> logErrors{};
+  std::size_t count{0};
+  std::size_t index{0};
+  double lastSign{0};
+  double decayRate{0};
+
+  /**
+   * Fits the decay and checks the prediction.
+   *
+   * @param ierror The current error.
+   * @return Whether the predicted error is within atTargetError.
+   */
+  bool predictSettled(double ierror);
+};
+} // namespace okapi
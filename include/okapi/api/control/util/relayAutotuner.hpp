@@ -0,0 +1,178 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/controllerInput.hpp"
+#include "okapi/api/control/controllerOutput.hpp"
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/iterative/iterativeVelPidController.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <cstddef>
+#include <memory>
+
+namespace okapi {
+/**
+ * Identifies the ultimate gain and period of a mechanism with a relay feedback experiment
+ * (Astrom-Hagglund) and turns them into starting PID gains. The output is switched between
+ * bias + amplitude and bias - amplitude whenever the reading crosses the setpoint, which drives
+ * the mechanism into a small, stable oscillation at its ultimate period. A few cycles take a few
+ * seconds, where PIDTuner needs a full step response per particle per iteration.
+ *
+ * For a mechanism which is loaded one way (an arm against gravity) or which only runs one way (a
+ * flywheel), set the bias to the output which holds the setpoint and the amplitude small enough
+ * that bias +/- amplitude stays in range.
+ */
+class RelayAutotuner {
+  public:
+  /**
+   * The rule used to turn the ultimate gain and period into PID gains.
+   */
+  enum class TuningRule {
+    zieglerNichols, ///< Classic Ziegler-Nichols. Fast, with about 25% overshoot.
+    tyreusLuyben,   ///< Tyreus-Luyben. Slower, with much less overshoot and more robustness.
+    noOvershoot     ///< Ziegler-Nichols "no overshoot" variant.
+  };
+
+  struct Result {
+    /**
+     * Whether enough consistent cycles were seen to trust the identification.
+     */
+    bool valid{false};
+
+    /**
+     * The ultimate gain, in output units per reading unit.
+     */
+    double ultimateGain{0};
+
+    /**
+     * The ultimate period.
+     */
+    QTime ultimatePeriod{0_ms};
+
+    /**
+     * The mean half peak-to-peak amplitude of the reading.
+     */
+    double amplitude{0};
+
+    /**
+     * The mean reading over the measured cycles.
+     */
+    double meanReading{0};
+
+    /**
+     * The number of cycles used.
+     */
+    std::size_t cycles{0};
+
+    /**
+     * (max - min) / mean of the cycle periods. Large values mean the oscillation never settled
+     * into a limit cycle (noise, backlash or too few cycles).
+     */
+    double periodSpread{0};
+
+    /**
+     * (max - min) / mean of the cycle amplitudes.
+     */
+    double amplitudeSpread{0};
+
+    /**
+     * How unevenly the relay spends time high and low, from 0 (even) to 1. Large values mean the
+     * bias does not hold the setpoint and the identified gain is less accurate.
+     */
+    double asymmetry{0};
+  };
+
+  /**
+   * @param iinput The sensor to read from.
+   * @param ioutput The output to write to.
+   * @param itimeUtil See TimeUtil docs.
+   * @param isetpoint The reading to oscillate around.
+   * @param irelayAmplitude The amplitude of the relay output.
+   * @param ibias The output the relay is centered on.
+   * @param ihysteresis The distance the reading must cross the setpoint by before the relay
+   * switches. Set it above the sensor noise.
+   * @param inumCycles The number of cycles to measure.
+   * @param isettleCycles The number of cycles to run (and ignore) before measuring.
+   * @param itimeout The maximum time the experiment can run for.
+   * @param ilogger The logger this instance will log to.
+   */
+  RelayAutotuner(const std::shared_ptr<ControllerInput<double>> &iinput,
+                 const std::shared_ptr<ControllerOutput<double>> &ioutput,
+                 const TimeUtil &itimeUtil,
+                 double isetpoint,
+                 double irelayAmplitude,
+                 double ibias = 0,
+                 double ihysteresis = 0,
+                 std::size_t inumCycles = 4,
+                 std::size_t isettleCycles = 1,
+                 QTime itimeout = 10_s,
+                 const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  virtual ~RelayAutotuner();
+
+  /**
+   * Runs the relay experiment. Blocks until enough cycles were measured or the timeout is reached.
+   * The output is set to zero when it returns.
+   *
+   * @return The identification.
+   */
+  virtual Result autotune();
+
+  /**
+   * Computes gains for an IterativePosPIDController.
+   *
+   * @param iresult The identification.
+   * @param irule The tuning rule.
+   * @return The gains. kBias is zero.
+   */
+  static IterativePosPIDController::Gains
+  getPosGains(const Result &iresult, TuningRule irule = TuningRule::tyreusLuyben);
+
+  /**
+   * Computes gains for an IterativeVelPIDController. That controller accumulates its output every
+   * sample, so its kP acts as the integral gain per sample and its kD as the proportional gain
+   * per sample. kF is the bias over the mean reading, which holds the setpoint open loop.
+   *
+   * @param iresult The identification.
+   * @param ibias The bias the identification was run with.
+   * @param isampleTime The sample time of the controller.
+   * @param irule The tuning rule.
+   * @return The gains. kSF is zero.
+   */
+  static IterativeVelPIDController::Gains
+  getVelGains(const Result &iresult,
+              double ibias,
+              QTime isampleTime = 10_ms,
+              TuningRule irule = TuningRule::tyreusLuyben);
+
+  protected:
+  static constexpr QTime loopDelta = 10_ms; // NOLINT
+
+  std::shared_ptr<Logger> logger;
+  TimeUtil timeUtil;
+  std::shared_ptr<ControllerInput<double>> input;
+  std::shared_ptr<ControllerOutput<double>> output;
+
+  const double setpoint;
+  const double relayAmplitude;
+  const double bias;
+  const double hysteresis;
+  const std::size_t numCycles;
+  const std::size_t settleCycles;
+  const QTime timeout;
+
+  /**
+   * The proportional gain and the integral and derivative times, in seconds, for a rule.
+   */
+  static void ruleGains(const Result &iresult,
+                        TuningRule irule,
+                        double &okP,
+                        double &oTi,
+                        double &oTd);
+};
+} // namespace okapi
@@ -0,0 +1,148 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/flywheelSimulator.hpp"
+#include "okapi/api/control/util/pidTuner.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/supplier.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace okapi {
+/**
+ * A particle swarm PID tuner which evaluates each particle against a plant model instead of the
+ * real mechanism. Step responses run in virtual time, so a response which would take seconds on
+ * the robot takes microseconds, and the particles of each iteration are spread over several
+ * threads. Use it to narrow the gains down before validating the best few candidates on the
+ * robot (for example with a PIDTuner over a tight range around them).
+ *
+ * The search and the cost (settle time and ITAE) are the same as PIDTuner. Random numbers are
+ * only drawn between iterations, so the result for a given seed does not depend on the number of
+ * threads.
+ */
+class SimulatedPIDTuner {
+  public:
+  /**
+   * A plant model. Applies a controller output for one loop period and returns the new reading.
+   */
+  using Plant = std::function<double(double ioutput)>;
+
+  struct Candidate {
+    PIDTuner::Output gains;
+    double error;
+  };
+
+  /**
+   * @param iplantSupplier Makes a new plant, at rest, for every step response.
+   * @param itimeUtil Used to wait for the worker threads. It is not used for the simulation.
+   * @param itimeout The length of a step response in virtual time.
+   * @param igoal The target of the step response.
+   * @param inumIterations The number of swarm iterations.
+   * @param inumParticles The number of particles.
+   * @param ikSettle The weight of the settle time in the cost.
+   * @param ikITAE The weight of the ITAE in the cost.
+   * @param inumThreads The number of threads evaluating particles, including the calling one.
+   * @param iseed The seed for the swarm.
+   * @param iloopDelta The controller period in virtual time.
+   * @param ilogger The logger this instance will log to.
+   */
+  SimulatedPIDTuner(const Supplier<Plant> &iplantSupplier,
+                    const TimeUtil &itimeUtil,
+                    QTime itimeout,
+                    double igoal,
+                    double ikPMin,
+                    double ikPMax,
+                    double ikIMin,
+                    double ikIMax,
+                    double ikDMin,
+                    double ikDMax,
+                    std::size_t inumIterations = 20,
+                    std::size_t inumParticles = 64,
+                    double ikSettle = 1,
+                    double ikITAE = 2,
+                    std::size_t inumThreads = 1,
+                    std::uint32_t iseed = 0,
+                    QTime iloopDelta = 10_ms,
+                    const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  virtual ~SimulatedPIDTuner();
+
+  /**
+   * Runs the swarm.
+   *
+   * @param inumCandidates The number of candidates to return.
+   * @return The best gains found, best first.
+   */
+  virtual std::vector<Candidate> autotune(std::size_t inumCandidates = 3);
+
+  /**
+   * Runs one step response against a new plant.
+   *
+   * @param igains The gains to use.
+   * @return The cost of the response. Lower is better.
+   */
+  double evaluate(const PIDTuner::Output &igains) const;
+
+  /**
+   * Makes a plant supplier for a FlywheelSimulator. The controller output (-1 to 1) is scaled to
+   * the simulator's max torque and the reading is the simulator's angle.
+   *
+   * @param imakeSimulator Makes a new simulator. Its timestep is set to the loop period.
+   * @param iloopDelta The controller period.
+   */
+  static Supplier<Plant>
+  flywheelPlant(const std::function<std::unique_ptr<FlywheelSimulator>()> &imakeSimulator,
+                QTime iloopDelta = 10_ms);
+
+  protected:
+  static constexpr double inertia = 0.5;   // Particle inertia
+  static constexpr double confSelf = 1.1;  // Self confidence
+  static constexpr double confSwarm = 1.2; // Particle swarm confidence
+
+  struct Particle {
+    double pos, vel, best;
+  };
+
+  struct ParticleSet {
+    Particle kP, kI, kD;
+    double bestError;
+  };
+
+  std::shared_ptr<Logger> logger;
+  TimeUtil timeUtil;
+  Supplier<Plant> plantSupplier;
+
+  const QTime timeout;
+  const double goal;
+  const double kPMin;
+  const double kPMax;
+  const double kIMin;
+  const double kIMax;
+  const double kDMin;
+  const double kDMax;
+  const std::size_t numIterations;
+  const std::size_t numParticles;
+  const double kSettle;
+  const double kITAE;
+  const std::size_t numThreads;
+  const QTime loopDelta;
+  std::mt19937 rng;
+
+  /**
+   * Evaluates every particle's current position, in parallel.
+   *
+   * @param iparticles The particles.
+   * @param oerrors The cost of each particle.
+   */
+  void evaluateAll(const std::vector<ParticleSet> &iparticles, std::vector<double> &oerrors);
+};
+} // namespace okapi
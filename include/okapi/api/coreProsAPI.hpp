@@ -54,6 +54,24 @@ class CrossplatformThread {
   {
   }
 
+#ifdef THREADS_STD
+  CrossplatformThread(void (*ptr)(void *),
+                      void *params,
+                      std::uint32_t,
+                      std::uint16_t,
+                      const char *const = "OkapiLibCrossplatformTask")
+    : thread(ptr, params) {
+  }
+#else
+  CrossplatformThread(void (*ptr)(void *),
+                      void *params,
+                      const std::uint32_t ipriority,
+                      const std::uint16_t istackDepth,
+                      const char *const name = "OkapiLibCrossplatformTask")
+    : thread(pros::c::task_create(ptr, params, ipriority, istackDepth, name)) {
+  }
+#endif
+
   ~CrossplatformThread() {
 #ifdef THREADS_STD
     thread.join();
@@ -102,6 +120,33 @@ class CrossplatformThread {
 #endif
   }
 
+  /**
+   * Writes the current thread's name into a buffer, truncating it to fit. Unlike getName(), this
+   * doesn't allocate.
+   *
+   * @param obuffer The buffer.
+   * @param isize The size of the buffer, including the terminator.
+   */
+  static void getName(char *obuffer, const std::size_t isize) noexcept {
+    if (isize == 0) {
+      return;
+    }
+
+#ifdef THREADS_STD
+    snprintf(obuffer,
+             isize,
+             "%zu",
+             std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#else
+    const char *name = pros::c::task_get_name(NULL);
+    std::size_t i = 0;
+    for (; name && name[i] != '\0' && i < isize - 1; i++) {
+      obuffer[i] = name[i];
+    }
+    obuffer[i] = '\0';
+#endif
+  }
+
   CROSSPLATFORM_THREAD_T thread;
 };
 
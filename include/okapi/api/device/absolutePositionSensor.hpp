@@ -0,0 +1,58 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/units/QAngle.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include <cstdint>
+
+namespace okapi {
+struct PositionFix {
+  /**
+   * Whether this fix holds a new, usable measurement.
+   */
+  bool valid{false};
+
+  /**
+   * The position in StateMode::FRAME_TRANSFORMATION, like the odometry state.
+   */
+  QLength x{0_m};
+  QLength y{0_m};
+
+  /**
+   * Whether heading holds a measurement.
+   */
+  bool headingValid{false};
+
+  /**
+   * The heading in StateMode::FRAME_TRANSFORMATION, if the sensor measures one.
+   */
+  QAngle heading{0_deg};
+
+  /**
+   * The standard deviation of the position error reported by the sensor.
+   */
+  QLength stdDev{0_m};
+
+  /**
+   * The device time at which the fix was read, in milliseconds.
+   */
+  std::uint32_t timestamp{0};
+};
+
+class AbsolutePositionSensor {
+  public:
+  virtual ~AbsolutePositionSensor() = default;
+
+  /**
+   * Get the newest position fix. The fix is only marked valid the first time it is returned so
+   * that a consumer polling faster than the sensor updates does not reuse a measurement.
+   *
+   * @return the newest position fix.
+   */
+  virtual PositionFix getFix() = 0;
+};
+} // namespace okapi
@@ -0,0 +1,39 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace okapi {
+struct TimestampedReading {
+  /**
+   * The sensor value.
+   */
+  double value{0};
+
+  /**
+   * The device time at which the sensor value was sampled, in milliseconds.
+   */
+  std::uint32_t timestamp{0};
+};
+
+class TimestampedRotarySensor {
+  public:
+  virtual ~TimestampedRotarySensor() = default;
+
+  /**
+   * Get the latest sensor value together with the time the device sampled it. Unlike the time at
+   * which the value is read, the sample time does not include scheduling jitter of the reading
+   * task.
+   *
+   * Reads of the same sample must return the same timestamp.
+   *
+   * @return the latest sensor value and its sample time, or a value of ``OKAPI_PROS_ERR`` on a
+   * failure.
+   */
+  virtual TimestampedReading getTimestamped() const = 0;
+};
+} // namespace okapi
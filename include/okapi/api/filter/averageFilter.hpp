@@ -7,11 +7,19 @@
 
 #include "okapi/api/filter/filter.hpp"
 #include <array>
+#include <cmath>
 #include <cstddef>
 
 namespace okapi {
 /**
- * A filter which returns the average of a list of values.
+ * A filter which returns the average of a list of values. The sum of the window is kept as a
+ * compensated (Kahan) running sum, so most samples cost O(1) regardless of the number of taps. The
+ * sum is recomputed exactly once per pass over the window to keep rounding drift bounded, so every
+ * nth sample costs O(n); the cost is amortized O(1), but not constant per sample.
+ *
+ * Infinite and NaN readings are kept out of the running sum, so they can't poison it after they
+ * leave the window. While one is in the window the output is computed directly from the window,
+ * which gives the same inf or NaN result as a plain average would.
  *
  * @tparam n number of taps in the filter
  */
@@ -29,16 +37,37 @@ template <std::size_t n> class AverageFilter : public Filter {
    * @return filtered result
    */
   double filter(const double ireading) override {
+    const double removed = data[index];
     data[index++] = ireading;
+
+    if (!std::isfinite(removed)) {
+      nonFiniteCount--;
+    }
+    if (!std::isfinite(ireading)) {
+      nonFiniteCount++;
+    }
+
     if (index >= n) {
       index = 0;
+      resum();
+    } else {
+      if (std::isfinite(ireading)) {
+        add(ireading);
+      }
+      if (std::isfinite(removed)) {
+        add(-removed);
+      }
     }
 
-    output = 0.0;
-    for (size_t i = 0; i < n; i++)
-      output += data[i];
-    output /= (double)n;
-
+    if (nonFiniteCount > 0) {
+      double windowSum = 0;
+      for (const double value : data) {
+        windowSum += value;
+      }
+      output = windowSum / (double)n;
+    } else {
+      output = sum / (double)n;
+    }
     return output;
   }
 
@@ -55,5 +84,31 @@ template <std::size_t n> class AverageFilter : public Filter {
   std::array<double, n> data{0};
   std::size_t index = 0;
   double output = 0;
+  double sum = 0;
+  double compensation = 0;
+  std::size_t nonFiniteCount = 0;
+
+  /**
+   * Adds a value to the running sum using Kahan summation.
+   */
+  void add(const double ivalue) {
+    const double y = ivalue - compensation;
+    const double t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  }
+
+  /**
+   * Recomputes the running sum from the finite values in the window.
+   */
+  void resum() {
+    sum = 0;
+    compensation = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      if (std::isfinite(data[i])) {
+        add(data[i]);
+      }
+    }
+  }
 };
 } // namespace okapi
@@ -0,0 +1,295 @@
+/*
+ * Filter banks run the same filter over many independent channels (for example the velocity of
+ * every drive motor) in one call. State is stored as one array per quantity (struct of arrays)
+ * and every update is a straight loop over the channels with no branches or calls, which the
+ * compiler can vectorize.
+ *
+ * The V5 brain's Cortex-A9 NEON unit only has single precision lanes, so the banks default to
+ * float. Double precision banks work the same way, but run one lane at a time on the brain.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/util/mathUtil.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace okapi {
+/**
+ * A bank of exponential moving average filters. Same equations as EmaFilter.
+ *
+ * @tparam channels number of channels
+ * @tparam T the sample type
+ */
+template <std::size_t channels, typename T = float> class EmaFilterBank {
+  public:
+  using Samples = std::array<T, channels>;
+
+  /**
+   * @param ialpha alpha gain, shared by all channels
+   */
+  explicit EmaFilterBank(const T ialpha) {
+    alpha.fill(ialpha);
+  }
+
+  /**
+   * @param ialpha alpha gain for each channel
+   */
+  explicit EmaFilterBank(const Samples &ialpha) : alpha(ialpha) {
+  }
+
+  /**
+   * Filters one sample of every channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Samples &filter(const Samples &ireadings) {
+    for (std::size_t i = 0; i < channels; i++) {
+      output[i] = alpha[i] * ireadings[i] + (T(1) - alpha[i]) * output[i];
+    }
+    return output;
+  }
+
+  /**
+   * @return the previous outputs from filter
+   */
+  const Samples &getOutput() const {
+    return output;
+  }
+
+  protected:
+  alignas(16) Samples alpha{};
+  alignas(16) Samples output{};
+};
+
+/**
+ * A bank of double exponential moving average filters. Same equations as DemaFilter.
+ *
+ * @tparam channels number of channels
+ * @tparam T the sample type
+ */
+template <std::size_t channels, typename T = float> class DemaFilterBank {
+  public:
+  using Samples = std::array<T, channels>;
+
+  /**
+   * @param ialpha alpha gain, shared by all channels
+   * @param ibeta beta gain, shared by all channels
+   */
+  DemaFilterBank(const T ialpha, const T ibeta) {
+    alpha.fill(ialpha);
+    beta.fill(ibeta);
+  }
+
+  /**
+   * @param ialpha alpha gain for each channel
+   * @param ibeta beta gain for each channel
+   */
+  DemaFilterBank(const Samples &ialpha, const Samples &ibeta) : alpha(ialpha), beta(ibeta) {
+  }
+
+  /**
+   * Filters one sample of every channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Samples &filter(const Samples &ireadings) {
+    for (std::size_t i = 0; i < channels; i++) {
+      const T s = alpha[i] * ireadings[i] + (T(1) - alpha[i]) * (outputS[i] + outputB[i]);
+      const T b = beta[i] * (s - outputS[i]) + (T(1) - beta[i]) * outputB[i];
+      outputS[i] = s;
+      outputB[i] = b;
+      output[i] = s + b;
+    }
+    return output;
+  }
+
+  /**
+   * @return the previous outputs from filter
+   */
+  const Samples &getOutput() const {
+    return output;
+  }
+
+  protected:
+  alignas(16) Samples alpha{};
+  alignas(16) Samples beta{};
+  alignas(16) Samples outputS{};
+  alignas(16) Samples outputB{};
+  alignas(16) Samples output{};
+};
+
+/**
+ * A bank of moving average filters. Same output as AverageFilter, using the same compensated
+ * running sum with an exact re-sum once per pass over the window, and the same handling of
+ * infinite and NaN readings in each channel.
+ *
+ * @tparam channels number of channels
+ * @tparam taps number of taps in each filter
+ * @tparam T the sample type
+ */
+template <std::size_t channels, std::size_t taps, typename T = float> class AverageFilterBank {
+  static_assert(taps > 0, "AverageFilterBank needs at least one tap.");
+
+  public:
+  using Samples = std::array<T, channels>;
+
+  AverageFilterBank() = default;
+
+  /**
+   * Filters one sample of every channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Samples &filter(const Samples &ireadings) {
+    Samples &slot = data[index++];
+
+    for (std::size_t i = 0; i < channels; i++) {
+      if (!std::isfinite(slot[i])) {
+        nonFiniteCount[i]--;
+      }
+      if (!std::isfinite(ireadings[i])) {
+        nonFiniteCount[i]++;
+      }
+    }
+
+    if (index >= taps) {
+      index = 0;
+      slot = ireadings;
+      resum();
+    } else {
+      for (std::size_t i = 0; i < channels; i++) {
+        if (std::isfinite(ireadings[i])) {
+          add(i, ireadings[i]);
+        }
+        if (std::isfinite(slot[i])) {
+          add(i, -slot[i]);
+        }
+      }
+      slot = ireadings;
+    }
+
+    for (std::size_t i = 0; i < channels; i++) {
+      if (nonFiniteCount[i] > 0) {
+        T windowSum = 0;
+        for (std::size_t tap = 0; tap < taps; tap++) {
+          windowSum += data[tap][i];
+        }
+        output[i] = windowSum / T(taps);
+      } else {
+        output[i] = sum[i] / T(taps);
+      }
+    }
+    return output;
+  }
+
+  /**
+   * @return the previous outputs from filter
+   */
+  const Samples &getOutput() const {
+    return output;
+  }
+
+  protected:
+  alignas(16) std::array<Samples, taps> data{};
+  alignas(16) Samples sum{};
+  alignas(16) Samples compensation{};
+  alignas(16) Samples output{};
+  std::array<std::size_t, channels> nonFiniteCount{};
+  std::size_t index = 0;
+
+  void add(const std::size_t ichannel, const T ivalue) {
+    const T y = ivalue - compensation[ichannel];
+    const T t = sum[ichannel] + y;
+    compensation[ichannel] = (t - sum[ichannel]) - y;
+    sum[ichannel] = t;
+  }
+
+  void resum() {
+    sum.fill(T(0));
+    compensation.fill(T(0));
+    for (std::size_t tap = 0; tap < taps; tap++) {
+      for (std::size_t i = 0; i < channels; i++) {
+        if (std::isfinite(data[tap][i])) {
+          add(i, data[tap][i]);
+        }
+      }
+    }
+  }
+};
+
+/**
+ * A bank of one dimensional Kalman filters. Same equations as EKFFilter.
+ *
+ * @tparam channels number of channels
+ * @tparam T the sample type
+ */
+template <std::size_t channels, typename T = float> class EKFFilterBank {
+  public:
+  using Samples = std::array<T, channels>;
+
+  /**
+   * @param iQ process noise covariance, shared by all channels
+   * @param iR measurement noise covariance, shared by all channels
+   */
+  explicit EKFFilterBank(const T iQ = T(0.0001), const T iR = T(ipow(0.2, 2))) {
+    Q.fill(iQ);
+    R.fill(iR);
+    P.fill(T(1));
+  }
+
+  /**
+   * Filters one sample of every channel. Assumes the control inputs are zero.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Samples &filter(const Samples &ireadings) {
+    for (std::size_t i = 0; i < channels; i++) {
+      const T pMinus = P[i] + Q[i];
+      const T k = pMinus / (pMinus + R[i]);
+      xHat[i] = xHat[i] + k * (ireadings[i] - xHat[i]);
+      P[i] = (T(1) - k) * pMinus;
+    }
+    return xHat;
+  }
+
+  /**
+   * Filters one sample of every channel with control inputs.
+   *
+   * @param ireadings new measurements
+   * @param icontrols control inputs
+   * @return filtered results
+   */
+  const Samples &filter(const Samples &ireadings, const Samples &icontrols) {
+    for (std::size_t i = 0; i < channels; i++) {
+      const T xMinus = xHat[i] + icontrols[i];
+      const T pMinus = P[i] + Q[i];
+      const T k = pMinus / (pMinus + R[i]);
+      xHat[i] = xMinus + k * (ireadings[i] - xMinus);
+      P[i] = (T(1) - k) * pMinus;
+    }
+    return xHat;
+  }
+
+  /**
+   * @return the previous outputs from filter
+   */
+  const Samples &getOutput() const {
+    return xHat;
+  }
+
+  protected:
+  alignas(16) Samples Q{};
+  alignas(16) Samples R{};
+  alignas(16) Samples xHat{};
+  alignas(16) Samples P{};
+};
+} // namespace okapi
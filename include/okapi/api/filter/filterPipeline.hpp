@@ -0,0 +1,133 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/filter.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace okapi {
+/**
+ * An exponential moving average stage for FilterPipeline. Same equations as EmaFilter, but
+ * defined in the header so the pipeline can inline it.
+ */
+class EmaStage {
+  public:
+  /**
+   * @param ialpha alpha gain
+   */
+  explicit EmaStage(const double ialpha) : alpha(ialpha) {
+  }
+
+  double filter(const double ireading) {
+    output = alpha * ireading + (1.0 - alpha) * output;
+    return output;
+  }
+
+  double getOutput() const {
+    return output;
+  }
+
+  protected:
+  double alpha;
+  double output = 0;
+};
+
+/**
+ * A double exponential moving average stage for FilterPipeline. Same equations as DemaFilter,
+ * but defined in the header so the pipeline can inline it.
+ */
+class DemaStage {
+  public:
+  /**
+   * @param ialpha alpha gain
+   * @param ibeta beta gain
+   */
+  DemaStage(const double ialpha, const double ibeta) : alpha(ialpha), beta(ibeta) {
+  }
+
+  double filter(const double ireading) {
+    const double outputS = alpha * ireading + (1.0 - alpha) * (lastOutputS + lastOutputB);
+    const double outputB = beta * (outputS - lastOutputS) + (1.0 - beta) * lastOutputB;
+    lastOutputS = outputS;
+    lastOutputB = outputB;
+    return outputS + outputB;
+  }
+
+  double getOutput() const {
+    return lastOutputS + lastOutputB;
+  }
+
+  protected:
+  double alpha, beta;
+  double lastOutputS = 0;
+  double lastOutputB = 0;
+};
+
+/**
+ * A sequence of filters fused into one filter at compile time. The input signal is passed through
+ * each stage in sequence, like ComposableFilter, but the stages are stored by value and called
+ * without virtual dispatch, so header-defined stages (MedianFilter, AverageFilter,
+ * RunningMedianFilter, EmaStage, DemaStage) are inlined into one filter() and nothing is
+ * allocated.
+ *
+ * The pipeline is itself a Filter, so it can be handed to VelMath, FilteredControllerInput or a
+ * ComposableFilter wherever a std::shared_ptr<Filter> is expected.
+ *
+ * Example:
+ *   auto filter = FilterPipeline<MedianFilter<5>, EmaStage, DemaStage>(
+ *     MedianFilter<5>(), EmaStage(0.5), DemaStage(0.2, 0.05));
+ *
+ * @tparam Stages the stage types. Each must have ``double filter(double)`` and
+ * ``double getOutput() const``.
+ */
+template <typename... Stages> class FilterPipeline final : public Filter {
+  static_assert(sizeof...(Stages) > 0, "FilterPipeline needs at least one stage.");
+
+  public:
+  /**
+   * @param istages The stages to use in sequence.
+   */
+  explicit FilterPipeline(Stages... istages) : stages(std::move(istages)...) {
+  }
+
+  /**
+   * Filters a value.
+   *
+   * @param ireading A new measurement.
+   * @return The filtered result.
+   */
+  double filter(const double ireading) override {
+    output = run(ireading, std::index_sequence_for<Stages...>{});
+    return output;
+  }
+
+  /**
+   * @return The previous output from filter.
+   */
+  double getOutput() const override {
+    return output;
+  }
+
+  /**
+   * @return The stage at index I.
+   */
+  template <std::size_t I> auto &getStage() {
+    return std::get<I>(stages);
+  }
+
+  protected:
+  std::tuple<Stages...> stages;
+  double output = 0;
+
+  template <std::size_t... Is> double run(double ivalue, std::index_sequence<Is...>) {
+    // The qualified call skips virtual dispatch for stages which derive from Filter.
+    ((ivalue = std::get<Is>(stages).Stages::filter(ivalue)), ...);
+    return ivalue;
+  }
+};
+} // namespace okapi
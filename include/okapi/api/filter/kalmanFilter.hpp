@@ -0,0 +1,362 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/filter.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace okapi {
+/**
+ * A statically sized, row major matrix. Only the operations the Kalman filters need are
+ * provided. Everything lives in the object, so nothing is allocated.
+ *
+ * @tparam rows number of rows
+ * @tparam cols number of columns
+ */
+template <std::size_t rows, std::size_t cols> struct KfMatrix {
+  std::array<double, rows * cols> data{};
+
+  static KfMatrix identity() {
+    static_assert(rows == cols, "Only square matrices have an identity.");
+    KfMatrix out;
+    for (std::size_t i = 0; i < rows; i++) {
+      out(i, i) = 1;
+    }
+    return out;
+  }
+
+  double &operator()(const std::size_t irow, const std::size_t icol) {
+    return data[irow * cols + icol];
+  }
+
+  double operator()(const std::size_t irow, const std::size_t icol) const {
+    return data[irow * cols + icol];
+  }
+
+  KfMatrix operator+(const KfMatrix &rhs) const {
+    KfMatrix out;
+    for (std::size_t i = 0; i < rows * cols; i++) {
+      out.data[i] = data[i] + rhs.data[i];
+    }
+    return out;
+  }
+
+  KfMatrix operator-(const KfMatrix &rhs) const {
+    KfMatrix out;
+    for (std::size_t i = 0; i < rows * cols; i++) {
+      out.data[i] = data[i] - rhs.data[i];
+    }
+    return out;
+  }
+
+  template <std::size_t other>
+  KfMatrix<rows, other> operator*(const KfMatrix<cols, other> &rhs) const {
+    KfMatrix<rows, other> out;
+    for (std::size_t i = 0; i < rows; i++) {
+      for (std::size_t k = 0; k < cols; k++) {
+        const double lhs = (*this)(i, k);
+        for (std::size_t j = 0; j < other; j++) {
+          out(i, j) += lhs * rhs(k, j);
+        }
+      }
+    }
+    return out;
+  }
+
+  KfMatrix<cols, rows> transpose() const {
+    KfMatrix<cols, rows> out;
+    for (std::size_t i = 0; i < rows; i++) {
+      for (std::size_t j = 0; j < cols; j++) {
+        out(j, i) = (*this)(i, j);
+      }
+    }
+    return out;
+  }
+
+  /**
+   * Inverts a square matrix by Gauss-Jordan elimination with partial pivoting.
+   *
+   * @param oinverse The inverse.
+   * @return Whether the matrix was invertible.
+   */
+  bool inverse(KfMatrix &oinverse) const {
+    static_assert(rows == cols, "Only square matrices can be inverted.");
+    KfMatrix a = *this;
+    oinverse = identity();
+
+    for (std::size_t col = 0; col < cols; col++) {
+      std::size_t pivot = col;
+      for (std::size_t row = col + 1; row < rows; row++) {
+        if (std::abs(a(row, col)) > std::abs(a(pivot, col))) {
+          pivot = row;
+        }
+      }
+
+      if (std::abs(a(pivot, col)) < 1e-12) {
+        return false;
+      }
+
+      if (pivot != col) {
+        for (std::size_t j = 0; j < cols; j++) {
+          std::swap(a(pivot, j), a(col, j));
+          std::swap(oinverse(pivot, j), oinverse(col, j));
+        }
+      }
+
+      const double scale = 1.0 / a(col, col);
+      for (std::size_t j = 0; j < cols; j++) {
+        a(col, j) *= scale;
+        oinverse(col, j) *= scale;
+      }
+
+      for (std::size_t row = 0; row < rows; row++) {
+        const double factor = a(row, col);
+        if (row == col || factor == 0) {
+          continue;
+        }
+        for (std::size_t j = 0; j < cols; j++) {
+          a(row, j) -= factor * a(col, j);
+          oinverse(row, j) -= factor * oinverse(col, j);
+        }
+      }
+    }
+
+    return true;
+  }
+};
+
+/**
+ * A linear Kalman filter with a fixed number of states and measurements. For an extended Kalman
+ * filter, pass the propagated state and the Jacobians of the nonlinear models to the
+ * three-argument predict() and to correct().
+ *
+ * @tparam states number of states
+ * @tparam measurements number of measured values
+ */
+template <std::size_t states, std::size_t measurements> class KalmanFilter {
+  public:
+  using State = KfMatrix<states, 1>;
+  using StateMatrix = KfMatrix<states, states>;
+  using Measurement = KfMatrix<measurements, 1>;
+  using MeasurementMatrix = KfMatrix<measurements, states>;
+  using MeasurementCovariance = KfMatrix<measurements, measurements>;
+
+  /**
+   * @param iinitialCovariance The covariance of the initial (zero) state.
+   */
+  explicit KalmanFilter(const StateMatrix &iinitialCovariance = StateMatrix::identity())
+    : P(iinitialCovariance) {
+  }
+
+  /**
+   * Linear time update: x = F x, P = F P F^T + Q.
+   *
+   * @param iF The state transition matrix.
+   * @param iQ The process noise covariance.
+   */
+  void predict(const StateMatrix &iF, const StateMatrix &iQ) {
+    x = iF * x;
+    P = iF * P * iF.transpose() + iQ;
+  }
+
+  /**
+   * Extended time update: the caller propagates the state through its nonlinear model and passes
+   * the model's Jacobian to propagate the covariance.
+   *
+   * @param ix The propagated state.
+   * @param iF The Jacobian of the state transition at the previous state.
+   * @param iQ The process noise covariance.
+   */
+  void predict(const State &ix, const StateMatrix &iF, const StateMatrix &iQ) {
+    x = ix;
+    P = iF * P * iF.transpose() + iQ;
+  }
+
+  /**
+   * Linear measurement update with the innovation z - H x.
+   *
+   * @param iz The measurement.
+   * @param iH The measurement matrix.
+   * @param iR The measurement noise covariance.
+   * @return Whether the update was applied. False if the innovation covariance was singular.
+   */
+  bool update(const Measurement &iz, const MeasurementMatrix &iH, const MeasurementCovariance &iR) {
+    return correct(iz - iH * x, iH, iR);
+  }
+
+  /**
+   * Measurement update with an innovation computed by the caller, for nonlinear measurement
+   * models or measurements which need wrapping (e.g. angles).
+   *
+   * @param iinnovation The measurement minus the predicted measurement.
+   * @param iH The Jacobian of the measurement model at the predicted state.
+   * @param iR The measurement noise covariance.
+   * @return Whether the update was applied. False if the innovation covariance was singular.
+   */
+  bool correct(const Measurement &iinnovation,
+               const MeasurementMatrix &iH,
+               const MeasurementCovariance &iR) {
+    const auto PHt = P * iH.transpose();
+    MeasurementCovariance sInverse;
+    if (!(iH * PHt + iR).inverse(sInverse)) {
+      return false;
+    }
+
+    const auto K = PHt * sInverse;
+    x = x + K * iinnovation;
+
+    // Joseph form keeps P symmetric and positive semi-definite.
+    const auto IKH = StateMatrix::identity() - K * iH;
+    P = IKH * P * IKH.transpose() + K * iR * K.transpose();
+    return true;
+  }
+
+  /**
+   * @return The state estimate.
+   */
+  const State &getState() const {
+    return x;
+  }
+
+  /**
+   * @return The state covariance.
+   */
+  const StateMatrix &getCovariance() const {
+    return P;
+  }
+
+  /**
+   * Sets the state estimate and its covariance.
+   */
+  void setState(const State &ix, const StateMatrix &iP) {
+    x = ix;
+    P = iP;
+  }
+
+  protected:
+  State x{};
+  StateMatrix P;
+};
+
+/**
+ * A Kalman filter over position, velocity and acceleration of one axis, driven by position
+ * measurements. The process noise is that of a white noise jerk. Use it in place of a
+ * differentiating velocity estimate: it is a Filter over position, and also exposes the velocity
+ * and acceleration estimates.
+ *
+ * Unless a state is given with setState(), the first reading seeds the position estimate, with zero
+ * velocity and acceleration, so a signal far from zero doesn't have to be converged to.
+ */
+class ConstantAccelerationKalmanFilter : public Filter {
+  public:
+  /**
+   * @param isampleTime The time between measurements.
+   * @param ijerkVariance The variance of the jerk driving the model. Larger values track faster
+   * changes in acceleration, smaller values smooth more.
+   * @param imeasurementVariance The variance of a position measurement.
+   * @param iinitialCovariance The covariance of the state when it is seeded from the first reading.
+   */
+  ConstantAccelerationKalmanFilter(
+    const QTime &isampleTime,
+    const double ijerkVariance,
+    const double imeasurementVariance,
+    const KfMatrix<3, 3> &iinitialCovariance = KfMatrix<3, 3>::identity())
+    : kf(iinitialCovariance), initialCovariance(iinitialCovariance) {
+    const double dt = isampleTime.convert(second);
+
+    F = KfMatrix<3, 3>::identity();
+    F(0, 1) = dt;
+    F(0, 2) = dt * dt / 2;
+    F(1, 2) = dt;
+
+    const double dt2 = dt * dt, dt3 = dt2 * dt, dt4 = dt3 * dt, dt5 = dt4 * dt;
+    Q.data = {dt5 / 20, dt4 / 8, dt3 / 6, dt4 / 8, dt3 / 3, dt2 / 2, dt3 / 6, dt2 / 2, dt};
+    for (double &q : Q.data) {
+      q *= ijerkVariance;
+    }
+
+    H(0, 0) = 1;
+    R(0, 0) = imeasurementVariance;
+  }
+
+  /**
+   * Filters a position measurement.
+   *
+   * @param ireading new measurement
+   * @return the filtered position
+   */
+  double filter(const double ireading) override {
+    if (!seeded) {
+      KfMatrix<3, 1> initial;
+      initial(0, 0) = ireading;
+      kf.setState(initial, initialCovariance);
+      seeded = true;
+      return getOutput();
+    }
+
+    kf.predict(F, Q);
+    KfMatrix<1, 1> z;
+    z(0, 0) = ireading;
+    kf.update(z, H, R);
+    return getOutput();
+  }
+
+  /**
+   * Returns the previous output from filter.
+   *
+   * @return the previous output from filter
+   */
+  double getOutput() const override {
+    return kf.getState()(0, 0);
+  }
+
+  /**
+   * @return The velocity estimate in position units per second.
+   */
+  double getVelocity() const {
+    return kf.getState()(1, 0);
+  }
+
+  /**
+   * @return The acceleration estimate in position units per second squared.
+   */
+  double getAcceleration() const {
+    return kf.getState()(2, 0);
+  }
+
+  /**
+   * Sets the state estimate and its covariance. The next reading is filtered against it instead
+   * of seeding the state.
+   *
+   * @param istate The position, velocity and acceleration.
+   * @param icovariance The covariance of the state.
+   */
+  void setState(const KfMatrix<3, 1> &istate, const KfMatrix<3, 3> &icovariance) {
+    kf.setState(istate, icovariance);
+    seeded = true;
+  }
+
+  /**
+   * Forgets the state, so the next reading seeds it again.
+   */
+  void reset() {
+    seeded = false;
+  }
+
+  protected:
+  KalmanFilter<3, 1> kf;
+  KfMatrix<3, 3> initialCovariance;
+  bool seeded{false};
+  KfMatrix<3, 3> F;
+  KfMatrix<3, 3> Q;
+  KfMatrix<1, 3> H;
+  KfMatrix<1, 1> R;
+};
+} // namespace okapi
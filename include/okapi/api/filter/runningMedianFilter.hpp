@@ -0,0 +1,177 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/filter.hpp"
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace okapi {
+/**
+ * A filter which returns the median value of list of values. Produces the same output as
+ * MedianFilter, but keeps the window partially ordered in two heaps instead of re-selecting the
+ * median from a copy of the window on every sample, so each sample costs O(log n) instead of
+ * O(n). Use this for large windows.
+ *
+ * @tparam n number of taps in the filter
+ */
+template <std::size_t n> class RunningMedianFilter : public Filter {
+  static_assert(n > 0, "RunningMedianFilter needs at least one tap.");
+
+  public:
+  RunningMedianFilter() {
+    // The window starts full of zeros, which satisfies both heap orders for any split.
+    for (std::size_t i = 0; i < n; i++) {
+      where[i] = i;
+      if (i < loSize) {
+        lo[i] = i;
+      } else {
+        hi[i - loSize] = i;
+      }
+    }
+  }
+
+  /**
+   * Filters a value, like a sensor reading.
+   *
+   * @param ireading new measurement
+   * @return filtered result
+   */
+  double filter(const double ireading) override {
+    const std::size_t replaced = index++;
+    if (index >= n) {
+      index = 0;
+    }
+
+    data[replaced] = ireading;
+    const std::size_t pos = where[replaced];
+    if (pos < loSize) {
+      siftDownLo(siftUpLo(pos));
+    } else {
+      siftDownHi(siftUpHi(pos - loSize));
+    }
+
+    // Replacing one value can only break the ordering between the two heaps at their roots.
+    if (hiSize > 0 && data[lo[0]] > data[hi[0]]) {
+      std::swap(lo[0], hi[0]);
+      where[lo[0]] = 0;
+      where[hi[0]] = loSize;
+      siftDownLo(0);
+      siftDownHi(0);
+    }
+
+    output = data[lo[0]];
+    return output;
+  }
+
+  /**
+   * Returns the previous output from filter.
+   *
+   * @return the previous output from filter
+   */
+  double getOutput() const override {
+    return output;
+  }
+
+  protected:
+  /**
+   * The lower half of the window, including the median, in a max-heap. For an even number of
+   * taps this selects the lower of the two middle values, like MedianFilter.
+   */
+  static constexpr std::size_t loSize = (n - 1) / 2 + 1;
+
+  /**
+   * The upper half of the window in a min-heap.
+   */
+  static constexpr std::size_t hiSize = n - loSize;
+
+  std::array<double, n> data{0};
+  std::array<std::size_t, loSize> lo{};
+  std::array<std::size_t, hiSize> hi{};
+
+  /**
+   * The heap position of each element of data. Positions at or above loSize are in hi.
+   */
+  std::array<std::size_t, n> where{};
+  std::size_t index = 0;
+  double output = 0;
+
+  std::size_t siftUpLo(std::size_t ipos) {
+    while (ipos > 0) {
+      const std::size_t parent = (ipos - 1) / 2;
+      if (!(data[lo[parent]] < data[lo[ipos]])) {
+        break;
+      }
+      swapLo(ipos, parent);
+      ipos = parent;
+    }
+    return ipos;
+  }
+
+  void siftDownLo(std::size_t ipos) {
+    while (true) {
+      std::size_t largest = ipos;
+      const std::size_t left = 2 * ipos + 1;
+      const std::size_t right = left + 1;
+      if (left < loSize && data[lo[largest]] < data[lo[left]]) {
+        largest = left;
+      }
+      if (right < loSize && data[lo[largest]] < data[lo[right]]) {
+        largest = right;
+      }
+      if (largest == ipos) {
+        return;
+      }
+      swapLo(ipos, largest);
+      ipos = largest;
+    }
+  }
+
+  std::size_t siftUpHi(std::size_t ipos) {
+    while (ipos > 0) {
+      const std::size_t parent = (ipos - 1) / 2;
+      if (!(data[hi[ipos]] < data[hi[parent]])) {
+        break;
+      }
+      swapHi(ipos, parent);
+      ipos = parent;
+    }
+    return ipos;
+  }
+
+  void siftDownHi(std::size_t ipos) {
+    while (true) {
+      std::size_t smallest = ipos;
+      const std::size_t left = 2 * ipos + 1;
+      const std::size_t right = left + 1;
+      if (left < hiSize && data[hi[left]] < data[hi[smallest]]) {
+        smallest = left;
+      }
+      if (right < hiSize && data[hi[right]] < data[hi[smallest]]) {
+        smallest = right;
+      }
+      if (smallest == ipos) {
+        return;
+      }
+      swapHi(ipos, smallest);
+      ipos = smallest;
+    }
+  }
+
+  void swapLo(const std::size_t ia, const std::size_t ib) {
+    std::swap(lo[ia], lo[ib]);
+    where[lo[ia]] = ia;
+    where[lo[ib]] = ib;
+  }
+
+  void swapHi(const std::size_t ia, const std::size_t ib) {
+    std::swap(hi[ia], hi[ib]);
+    where[hi[ia]] = ia + loSize;
+    where[hi[ib]] = ib + loSize;
+  }
+};
+} // namespace okapi
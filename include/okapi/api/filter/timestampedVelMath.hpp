@@ -0,0 +1,151 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/device/rotarysensor/timestampedRotarySensor.hpp"
+#include "okapi/api/units/QAngularAcceleration.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/util/logging.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace okapi {
+/**
+ * Velocity math which uses the time each position was sampled by the device instead of the time
+ * the control loop ran. The velocity is the least-squares slope of the last n (time, position)
+ * samples, which averages out encoder quantization without the lag of a filter on a noisy
+ * difference. Repeated samples (the loop running faster than the device updates) and readings of
+ * PROS_ERR are ignored.
+ *
+ * @tparam n number of samples in the fit. Must be at least 2. Larger windows are smoother but
+ * lag by about half the window.
+ */
+template <std::size_t n> class TimestampedVelMath {
+  static_assert(n >= 2, "TimestampedVelMath needs at least two samples to fit a slope.");
+
+  public:
+  /**
+   * Throws a `std::invalid_argument` exception if `iticksPerRev` is zero.
+   *
+   * @param iticksPerRev The number of ticks per revolution (or whatever units you are using).
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit TimestampedVelMath(const double iticksPerRev,
+                              std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger())
+    : logger(std::move(ilogger)) {
+    setTicksPerRev(iticksPerRev);
+  }
+
+  /**
+   * Calculates the current velocity and acceleration. Returns the (filtered) velocity.
+   *
+   * @param ireading The new position measurement and the time the device sampled it at.
+   * @return The new velocity estimate.
+   */
+  QAngularSpeed step(const TimestampedReading &ireading) {
+    if (ireading.value == OKAPI_PROS_ERR) {
+      return vel;
+    }
+
+    if (count > 0 && ireading.timestamp == times[(index + n - 1) % n]) {
+      return vel;
+    }
+
+    times[index] = ireading.timestamp;
+    positions[index] = ireading.value;
+    index = (index + 1) % n;
+    if (count < n) {
+      count++;
+    }
+
+    if (count < 2) {
+      return vel;
+    }
+
+    const std::uint32_t newest = times[(index + n - 1) % n];
+
+    // Fit relative to the newest sample so large timestamps don't cost precision.
+    double meanT = 0, meanP = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      meanT += -static_cast<double>(newest - times[i]);
+      meanP += positions[i];
+    }
+    meanT /= count;
+    meanP /= count;
+
+    double sTT = 0, sTP = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      const double dt = -static_cast<double>(newest - times[i]) - meanT;
+      sTT += dt * dt;
+      sTP += dt * (positions[i] - meanP);
+    }
+
+    if (sTT <= 0) {
+      return vel;
+    }
+
+    // Slope is in ticks per millisecond.
+    const double slope = sTP / sTT;
+    const QAngularSpeed newVel = slope * 1000.0 / ticksPerRev * 360.0 * degree / second;
+
+    if (lastTime != 0) {
+      const double dt = static_cast<double>(newest - lastTime) / 1000.0;
+      if (dt > 0) {
+        accel = (newVel - vel) / (dt * second);
+      }
+    }
+
+    lastTime = newest;
+    vel = newVel;
+    return vel;
+  }
+
+  /**
+   * Sets ticks per revolution (or whatever units you are using). Throws a `std::invalid_argument`
+   * exception if iTPR is zero.
+   *
+   * @param iTPR The number of ticks per revolution.
+   */
+  void setTicksPerRev(const double iTPR) {
+    if (iTPR == 0) {
+      std::string msg = "TimestampedVelMath: Ticks per revolution cannot be zero.";
+      LOG_ERROR(msg);
+      throw std::invalid_argument(msg);
+    }
+
+    ticksPerRev = iTPR;
+  }
+
+  /**
+   * Returns the last calculated velocity.
+   */
+  QAngularSpeed getVelocity() const {
+    return vel;
+  }
+
+  /**
+   * Returns the last calculated acceleration.
+   */
+  QAngularAcceleration getAccel() const {
+    return accel;
+  }
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  double ticksPerRev{1};
+  std::array<std::uint32_t, n> times{};
+  std::array<double, n> positions{};
+  std::size_t index{0};
+  std::size_t count{0};
+  std::uint32_t lastTime{0};
+  QAngularSpeed vel{0_rpm};
+  QAngularAcceleration accel{0.0};
+};
+} // namespace okapi
@@ -0,0 +1,208 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/device/absolutePositionSensor.hpp"
+#include "okapi/api/device/rotarysensor/continuousRotarySensor.hpp"
+#include "okapi/api/odometry/timestampedOdometry.hpp"
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+struct FusedOdometryNoise {
+  /**
+   * Variance of the distance traveled per meter traveled, in m^2/m.
+   */
+  double distance{0.0025};
+
+  /**
+   * Variance of the encoder heading change per radian turned, in rad^2/rad.
+   */
+  double turn{0.01};
+
+  /**
+   * Variance of the encoder heading change per meter traveled (wheel scrub), in rad^2/m.
+   */
+  double turnPerDistance{0.0025};
+
+  /**
+   * Standard deviation of an IMU heading measurement.
+   */
+  QAngle imuHeading{0.5_deg};
+};
+
+class FusedOdometry : public TimestampedOdometry {
+  public:
+  /**
+   * Extended Kalman filter odometry over (x, y, theta). Encoder deltas drive the prediction, the
+   * IMU heading and, if present, absolute position fixes correct it.
+   *
+   * Measurements from the IMU and the position sensor arrive late, so the filter keeps the last
+   * ``historySize`` predictions along with the measurements applied to each. A late measurement
+   * is applied to the prediction it belongs to and the following predictions are replayed from
+   * their stored encoder deltas and measurements, so the estimate doesn't depend on the order the
+   * measurements arrive in. The replay is bounded by the history size, which bounds the cost of a
+   * step.
+   *
+   * Position fixes are in StateMode::FRAME_TRANSFORMATION like the state, but they are relative
+   * to the sensor's origin, so call setState() with a pose relative to that origin before relying
+   * on them.
+   *
+   * @param ileftEncoder The left tracking encoder.
+   * @param irightEncoder The right tracking encoder.
+   * @param iimu The IMU heading sensor, in degrees, clockwise positive. May be null.
+   * @param ipositionSensor The absolute position sensor. May be null.
+   * @param ichassisScales The chassis dimensions. The tpr must match the units the encoders
+   * report in.
+   * @param inoise The noise model.
+   * @param iimuLatency The time between the IMU sampling its heading and the heading being read.
+   * @param iimuPeriod The IMU's sample period. A heading equal to the last one fused is only fused
+   * again once this much time has passed, so a reading repeated between IMU samples doesn't
+   * shrink the covariance twice.
+   * @param ipositionLatency The time between the position sensor computing its fix and the fix
+   * being read.
+   * @param imodel The chassis model returned by getModel(). It is not used for sensing.
+   * @param ilogger The logger this instance will log to.
+   */
+  FusedOdometry(const std::shared_ptr<TimestampedRotarySensor> &ileftEncoder,
+                const std::shared_ptr<TimestampedRotarySensor> &irightEncoder,
+                const std::shared_ptr<ContinuousRotarySensor> &iimu,
+                const std::shared_ptr<AbsolutePositionSensor> &ipositionSensor,
+                const ChassisScales &ichassisScales,
+                const FusedOdometryNoise &inoise = FusedOdometryNoise(),
+                const QTime &iimuLatency = 10_ms,
+                const QTime &iimuPeriod = 10_ms,
+                const QTime &ipositionLatency = 60_ms,
+                const std::shared_ptr<ReadOnlyChassisModel> &imodel = nullptr,
+                const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~FusedOdometry() override = default;
+
+  /**
+   * Do one odometry step.
+   */
+  void step() override;
+
+  /**
+   * @return The state covariance, row major over (x [m], y [m], theta [rad]).
+   */
+  std::array<double, 9> getCovariance() const;
+
+  /**
+   * The number of predictions kept for latency compensation. At a 5 ms step this covers 160 ms.
+   */
+  static constexpr std::size_t historySize = 32;
+
+  /**
+   * The most measurements kept for one prediction. Further measurements belonging to the same
+   * prediction are dropped.
+   */
+  static constexpr std::size_t maxMeasurements = 4;
+
+  protected:
+  using Vector = std::array<double, 3>;
+  using Matrix = std::array<double, 9>;
+
+  struct Measurement {
+    enum class Type { heading, position };
+    Type type{Type::heading};
+
+    /**
+     * The heading in radians, or the x position in meters.
+     */
+    double a{0};
+
+    /**
+     * The y position in meters. Unused for a heading.
+     */
+    double b{0};
+
+    /**
+     * The variance of a position, in m^2. Unused for a heading.
+     */
+    double variance{0};
+  };
+
+  struct Entry {
+    std::uint32_t timestamp{0};
+    Vector state{};
+    Matrix covariance{};
+    double distance{0};
+    double turn{0};
+    std::array<Measurement, maxMeasurements> measurements{};
+    std::size_t measurementCount{0};
+  };
+
+  std::shared_ptr<ContinuousRotarySensor> imu;
+  std::shared_ptr<AbsolutePositionSensor> positionSensor;
+  FusedOdometryNoise noise;
+  std::uint32_t imuLatency;
+  std::uint32_t imuPeriod;
+  std::uint32_t positionLatency;
+  double imuOffset{0};
+  bool imuOffsetValid{false};
+  double lastImuHeading{0};
+  std::uint32_t lastImuTime{0};
+  bool lastImuValid{false};
+  Vector x{};
+  Matrix P{};
+  std::array<Entry, historySize> history{};
+  std::size_t historyHead{0};
+  std::size_t historyCount{0};
+  Seqlock<Matrix> publishedCovariance;
+
+  /**
+   * Makes a state the current, certain state and clears the filter history.
+   *
+   * @param istate The new state in frame transformation format.
+   */
+  void applyState(const OdomState &istate) override;
+
+  /**
+   * Checks whether an IMU heading is a new sample rather than the previous sample read again, and
+   * records it if it is.
+   *
+   * @param iheading The heading, in degrees.
+   * @param itime The time the heading was read, in milliseconds.
+   * @return Whether the heading should be fused.
+   */
+  bool isNewImuSample(double iheading, std::uint32_t itime);
+
+  /**
+   * Propagates a state and covariance over one set of encoder deltas.
+   */
+  void predict(Vector &ioX, Matrix &ioP, double idistance, double iturn) const;
+
+  /**
+   * Applies a heading measurement to a state and covariance.
+   */
+  void correctHeading(Vector &ioX, Matrix &ioP, double iheading) const;
+
+  /**
+   * Applies a position measurement to a state and covariance.
+   */
+  void correctPosition(Vector &ioX, Matrix &ioP, double ix, double iy, double ivariance) const;
+
+  /**
+   * Applies a heading or position measurement to a state and covariance.
+   */
+  void correct(Vector &ioX, Matrix &ioP, const Measurement &imeasurement) const;
+
+  /**
+   * Applies a measurement taken at a past time to the history entry it belongs to, stores it with
+   * that entry, and replays the newer entries with their own measurements.
+   *
+   * @param itimestamp The time the measurement was taken at.
+   * @param imeasurement The measurement.
+   */
+  void correctAt(std::uint32_t itimestamp, const Measurement &imeasurement);
+
+  /**
+   * Copies the filter state into the OdomState returned by getState() and publishes it.
+   */
+  void publishState();
+};
+} // namespace okapi
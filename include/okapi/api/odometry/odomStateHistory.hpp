@@ -0,0 +1,267 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/odometry/odomState.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace okapi {
+/**
+ * A fixed-capacity history of timestamped odometry states. One task (normally the odometry task)
+ * pushes states and any number of other tasks read them without locking. Readers never block the
+ * writer; a reader that races with the writer on a slot retries that slot.
+ *
+ * Measurements which arrive late (vision, distance sensor, GPS) can be matched against the pose
+ * at their sample time with getStateAt(), and a correction to that past pose can be carried to
+ * the present with propagate().
+ *
+ * @tparam n number of states kept. At a 5 ms odometry step, 64 states cover 320 ms.
+ */
+template <std::size_t n> class OdomStateHistory {
+  static_assert(n >= 2, "OdomStateHistory needs room for at least two states.");
+
+  public:
+  OdomStateHistory() = default;
+
+  OdomStateHistory(const OdomStateHistory &) = delete;
+  OdomStateHistory &operator=(const OdomStateHistory &) = delete;
+
+  /**
+   * Adds a state. Must only be called from one task. Timestamps must not decrease.
+   *
+   * @param itime The time the state corresponds to.
+   * @param istate The state, in frame transformation format.
+   */
+  void push(const QTime &itime, const OdomState &istate) {
+    const std::uint32_t count = written.load(std::memory_order_relaxed);
+    Slot &slot = slots[count % n];
+
+    const std::uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time = itime.convert(millisecond);
+    slot.x = istate.x.convert(meter);
+    slot.y = istate.y.convert(meter);
+    slot.theta = istate.theta.convert(radian);
+    slot.seq.store(seq + 2, std::memory_order_release);
+
+    written.store(count + 1, std::memory_order_release);
+  }
+
+  /**
+   * Removes all states. Must only be called from the task which pushes states.
+   */
+  void clear() {
+    start.store(written.load(std::memory_order_relaxed), std::memory_order_release);
+  }
+
+  /**
+   * @return The number of states currently available.
+   */
+  std::size_t size() const {
+    const std::uint32_t count = written.load(std::memory_order_acquire);
+    return available(count);
+  }
+
+  /**
+   * Returns the state at a given time, interpolating between the two stored states around it.
+   * Times newer than the newest state return the newest state and times older than the oldest
+   * state return the oldest state.
+   *
+   * @param itime The time to get the state at.
+   * @param ostate The state at the given time, in frame transformation format.
+   * @return Whether a state was available. False if the history is empty.
+   */
+  bool getStateAt(const QTime &itime, OdomState &ostate) const {
+    const double t = itime.convert(millisecond);
+
+    for (std::size_t attempt = 0; attempt < maxAttempts; attempt++) {
+      const std::uint32_t count = written.load(std::memory_order_acquire);
+      const std::uint32_t stored = available(count);
+      if (stored == 0) {
+        return false;
+      }
+
+      const std::uint32_t oldest = count - stored;
+      Entry newer, older;
+
+      if (!readSlot(count - 1, newer)) {
+        continue;
+      }
+      if (t >= newer.time) {
+        ostate = newer.state();
+        return true;
+      }
+
+      if (!readSlot(oldest, older)) {
+        continue;
+      }
+      if (t <= older.time) {
+        ostate = older.state();
+        return true;
+      }
+
+      // Binary search for the first state newer than t. Each probe is read consistently; if the
+      // writer laps the search the final bracket check fails and the search is retried.
+      std::uint32_t lo = oldest;
+      std::uint32_t hi = count - 1;
+      bool consistent = true;
+      while (hi - lo > 1) {
+        const std::uint32_t mid = lo + (hi - lo) / 2;
+        Entry probe;
+        if (!readSlot(mid, probe)) {
+          consistent = false;
+          break;
+        }
+        if (probe.time > t) {
+          hi = mid;
+          newer = probe;
+        } else {
+          lo = mid;
+          older = probe;
+        }
+      }
+
+      if (!consistent || written.load(std::memory_order_acquire) - lo > n) {
+        continue;
+      }
+      if (!(older.time <= t && t <= newer.time)) {
+        continue;
+      }
+
+      const double span = newer.time - older.time;
+      const double alpha = span > 0 ? (t - older.time) / span : 1;
+      ostate = OdomState{(older.x + (newer.x - older.x) * alpha) * meter,
+                         (older.y + (newer.y - older.y) * alpha) * meter,
+                         (older.theta + (newer.theta - older.theta) * alpha) * radian};
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Carries a corrected past state to the present. The motion measured between the past time and
+   * the newest state is applied, in the robot's frame, on top of the corrected state.
+   *
+   * @param itime The time the corrected state corresponds to.
+   * @param icorrected The corrected state at that time, in frame transformation format.
+   * @param ostate The corrected present state, in frame transformation format.
+   * @return Whether the history had states to propagate over.
+   */
+  bool propagate(const QTime &itime, const OdomState &icorrected, OdomState &ostate) const {
+    OdomState past, present;
+    if (!getStateAt(itime, past) || !getLatest(present)) {
+      return false;
+    }
+
+    const double pastTheta = past.theta.convert(radian);
+    const double dx = (present.x - past.x).convert(meter);
+    const double dy = (present.y - past.y).convert(meter);
+
+    // Express the motion in the past pose's frame, then re-apply it from the corrected pose.
+    const double localX = dx * std::cos(pastTheta) + dy * std::sin(pastTheta);
+    const double localY = -dx * std::sin(pastTheta) + dy * std::cos(pastTheta);
+    const double c = std::cos(icorrected.theta.convert(radian));
+    const double s = std::sin(icorrected.theta.convert(radian));
+
+    ostate = OdomState{icorrected.x + (localX * c - localY * s) * meter,
+                       icorrected.y + (localX * s + localY * c) * meter,
+                       icorrected.theta + (present.theta - past.theta)};
+    return true;
+  }
+
+  /**
+   * Returns the newest state.
+   *
+   * @param ostate The newest state, in frame transformation format.
+   * @return Whether a state was available. False if the history is empty.
+   */
+  bool getLatest(OdomState &ostate) const {
+    for (std::size_t attempt = 0; attempt < maxAttempts; attempt++) {
+      const std::uint32_t count = written.load(std::memory_order_acquire);
+      if (available(count) == 0) {
+        return false;
+      }
+
+      Entry entry;
+      if (readSlot(count - 1, entry)) {
+        ostate = entry.state();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  protected:
+  struct Slot {
+    std::atomic<std::uint32_t> seq{0};
+    double time{0};
+    double x{0};
+    double y{0};
+    double theta{0};
+  };
+
+  struct Entry {
+    double time{0};
+    double x{0};
+    double y{0};
+    double theta{0};
+
+    OdomState state() const {
+      return OdomState{x * meter, y * meter, theta * radian};
+    }
+  };
+
+  static constexpr std::size_t maxAttempts = 8;
+
+  std::array<Slot, n> slots{};
+  std::atomic<std::uint32_t> written{0};
+  std::atomic<std::uint32_t> start{0};
+
+  /**
+   * @return The number of states which can be read when ``icount`` states have been written.
+   */
+  std::uint32_t available(const std::uint32_t icount) const {
+    const std::uint32_t sinceClear = icount - start.load(std::memory_order_acquire);
+    return sinceClear < n ? sinceClear : n;
+  }
+
+  /**
+   * Reads the slot holding the state with the given index.
+   *
+   * @return Whether a consistent copy of that state was read. False if the writer was writing
+   * the slot or has since replaced the state.
+   */
+  bool readSlot(const std::uint32_t iindex, Entry &oentry) const {
+    const Slot &slot = slots[iindex % n];
+    const std::uint32_t before = slot.seq.load(std::memory_order_acquire);
+    if (before & 1) {
+      return false;
+    }
+
+    oentry.time = slot.time;
+    oentry.x = slot.x;
+    oentry.y = slot.y;
+    oentry.theta = slot.theta;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+
+    // Each pass over the ring adds 2 to the slot's sequence number, so the pass count tells
+    // whether this is still the state with the requested index.
+    return before / 2 == iindex / n + 1;
+  }
+};
+} // namespace okapi
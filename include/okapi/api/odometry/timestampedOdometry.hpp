@@ -0,0 +1,176 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/device/rotarysensor/timestampedRotarySensor.hpp"
+#include "okapi/api/odometry/odometry.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/seqlock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace okapi {
+class TimestampedOdometry : public Odometry {
+  public:
+  /**
+   * Two encoder odometry driven by the sensors' own sample timestamps rather than the time the
+   * odometry task happened to wake up. A step is only taken once both encoders have produced a new
+   * sample, so the two wheel deltas cover the same samples, and steps where either encoder is
+   * stale are skipped. A sample counts as new when its timestamp differs from the previous one, so
+   * an encoder must report the same timestamp every time it is read until it samples again. This means it can be stepped faster than the sensors update without
+   * accumulating zero-length steps. The pose integration only uses the tick deltas; the sample
+   * timestamps are used for the velocity estimates and getStateTime(). Meant to be run by an
+   * OdometryTask.
+   *
+   * The state is published without locks, so getState() and the velocity getters can be called
+   * from any task while another task steps the odometry, and always return values from the same
+   * step.
+   *
+   * @param ileftEncoder The left tracking encoder.
+   * @param irightEncoder The right tracking encoder.
+   * @param ichassisScales The chassis dimensions. The tpr must match the units the encoders
+   * report in.
+   * @param imodel The chassis model returned by getModel(). It is not used for sensing.
+   * @param ilogger The logger this instance will log to.
+   */
+  TimestampedOdometry(const std::shared_ptr<TimestampedRotarySensor> &ileftEncoder,
+                      const std::shared_ptr<TimestampedRotarySensor> &irightEncoder,
+                      const ChassisScales &ichassisScales,
+                      const std::shared_ptr<ReadOnlyChassisModel> &imodel = nullptr,
+                      const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  virtual ~TimestampedOdometry() = default;
+
+  /**
+   * Sets the drive and turn scales. Like setState(), the scales are handed to the stepping task
+   * and used from the next step, and getScales() returns them straight away.
+   */
+  void setScales(const ChassisScales &ichassisScales) override;
+
+  /**
+   * Do one odometry step.
+   */
+  void step() override;
+
+  /**
+   * Returns the current state.
+   *
+   * @param imode The mode to return the state in.
+   * @return The current state in the given format.
+   */
+  OdomState getState(const StateMode &imode = StateMode::FRAME_TRANSFORMATION) const override;
+
+  /**
+   * Sets a new state to be the current state. The state is handed to the stepping task and takes
+   * effect at the start of the next step, so this can be called from any task while the odometry
+   * is being stepped. Until then getState() returns the new state, so a getState() straight after
+   * a setState() sees it even if nothing is stepping the odometry. It must not be called from two
+   * tasks at once.
+   *
+   * @param istate The new state in the given format.
+   * @param imode The mode to treat the input state as.
+   */
+  void setState(const OdomState &istate,
+                const StateMode &imode = StateMode::FRAME_TRANSFORMATION) override;
+
+  /**
+   * @return The internal ChassisModel.
+   */
+  std::shared_ptr<ReadOnlyChassisModel> getModel() override;
+
+  /**
+   * @return The internal ChassisScales.
+   */
+  ChassisScales getScales() override;
+
+  /**
+   * @return The device time of the newest sample included in the current state.
+   */
+  QTime getStateTime() const;
+
+  /**
+   * @return The linear velocity over the last step, computed from the sample times.
+   */
+  QSpeed getLinearVelocity() const;
+
+  /**
+   * @return The angular velocity over the last step, computed from the sample times.
+   */
+  QAngularSpeed getAngularVelocity() const;
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  std::shared_ptr<TimestampedRotarySensor> leftEncoder;
+  std::shared_ptr<TimestampedRotarySensor> rightEncoder;
+  std::shared_ptr<ReadOnlyChassisModel> model;
+  ChassisScales chassisScales;
+  OdomState state;
+  TimestampedReading lastLeft;
+  TimestampedReading lastRight;
+  bool hasLastReading{false};
+  QSpeed linearVelocity{0_mps};
+  QAngularSpeed angularVelocity{0_rpm};
+  const double maximumTickDiff{1000};
+
+  struct Snapshot {
+    OdomState state;
+    QSpeed linearVelocity{0_mps};
+    QAngularSpeed angularVelocity{0_rpm};
+    std::uint32_t time{0};
+  };
+
+  Seqlock<Snapshot> published;
+  Seqlock<OdomState> requestedState;
+  std::atomic<std::uint32_t> requestedVersion{0};
+  std::atomic<std::uint32_t> appliedVersion{0};
+
+  CrossplatformMutex scalesMutex;
+  ChassisScales requestedScales;
+  std::atomic_bool scalesRequested{false};
+
+  /**
+   * Applies a state passed to setState() and scales passed to setScales(), if there are any.
+   * Called by the stepping task. The state stays pending until it has been published, so readers
+   * never see the old state in between.
+   */
+  void applyRequestedState();
+
+  /**
+   * Makes a state the current state. Called by the stepping task.
+   *
+   * @param istate The new state in frame transformation format.
+   */
+  virtual void applyState(const OdomState &istate);
+
+  /**
+   * Publishes the current state and velocities to readers. Called by the stepping task.
+   */
+  void publish();
+
+  /**
+   * Reads both encoders and computes the tick differences since the last sample. Updates the
+   * velocity estimates.
+   *
+   * @param oleftDiff The left tick difference, if a step should be taken.
+   * @param orightDiff The right tick difference, if a step should be taken.
+   * @return Whether both encoders produced a new, valid sample.
+   */
+  bool readEncoderDiffs(double &oleftDiff, double &orightDiff);
+
+  /**
+   * Does the math, side-effect free, for one odom step.
+   *
+   * @param ileftDiff The left tick difference from the previous step to this step.
+   * @param irightDiff The right tick difference from the previous step to this step.
+   * @return The newly computed OdomState.
+   */
+  virtual OdomState odomMathStep(double ileftDiff, double irightDiff) const;
+};
+} // namespace okapi
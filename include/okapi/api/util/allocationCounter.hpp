@@ -0,0 +1,72 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace okapi {
+class AllocationCounter {
+  public:
+  /**
+   * Counts calls to the global operator new and operator delete, to check that code performs no
+   * heap allocations. Counting is only compiled into host builds which define both THREADS_STD
+   * and OKAPI_COUNT_ALLOCATIONS, because it replaces the global operators. Otherwise every count
+   * stays at zero.
+   *
+   * @return Whether allocations are being counted.
+   */
+  static constexpr bool isEnabled() {
+#if defined(THREADS_STD) && defined(OKAPI_COUNT_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @return The number of allocations since the program started.
+   */
+  static std::size_t getAllocations() noexcept;
+
+  /**
+   * @return The number of deallocations since the program started.
+   */
+  static std::size_t getDeallocations() noexcept;
+};
+
+class AllocationScope {
+  public:
+  /**
+   * Counts the allocations made while the scope is alive, across all threads.
+   *
+   * AllocationScope scope;
+   * controller.step();
+   * assert(scope.getAllocations() == 0);
+   */
+  AllocationScope() noexcept
+    : startAllocations(AllocationCounter::getAllocations()),
+      startDeallocations(AllocationCounter::getDeallocations()) {
+  }
+
+  /**
+   * @return The number of allocations since the scope was made.
+   */
+  std::size_t getAllocations() const noexcept {
+    return AllocationCounter::getAllocations() - startAllocations;
+  }
+
+  /**
+   * @return The number of deallocations since the scope was made.
+   */
+  std::size_t getDeallocations() const noexcept {
+    return AllocationCounter::getDeallocations() - startDeallocations;
+  }
+
+  protected:
+  std::size_t startAllocations;
+  std::size_t startDeallocations;
+};
+} // namespace okapi
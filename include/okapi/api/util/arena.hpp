@@ -0,0 +1,313 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/coreProsAPI.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace okapi {
+/**
+ * A bump allocator over a fixed buffer stored inside the arena. Allocating moves an offset
+ * forward and freeing does nothing; reset() frees everything at once. Use one for scratch memory
+ * which lives for a single control cycle: reset it at the top of the cycle and nothing touches the
+ * heap.
+ *
+ * An arena is not thread-safe, so give each task its own.
+ *
+ * @tparam Bytes The size of the buffer.
+ */
+template <std::size_t Bytes> class FixedArena {
+  public:
+  FixedArena() = default;
+
+  FixedArena(const FixedArena &) = delete;
+  FixedArena &operator=(const FixedArena &) = delete;
+
+  /**
+   * Allocates from the arena.
+   *
+   * @param isize The number of bytes.
+   * @param ialign The alignment, a power of two no greater than alignof(std::max_align_t).
+   * @return The memory, or nullptr if the arena doesn't have room.
+   */
+  void *allocate(const std::size_t isize,
+                 const std::size_t ialign = alignof(std::max_align_t)) noexcept {
+    if (ialign > alignof(std::max_align_t)) {
+      return nullptr;
+    }
+
+    const std::size_t start = (offset + ialign - 1) & ~(ialign - 1);
+    if (start > Bytes || isize > Bytes - start) {
+      return nullptr;
+    }
+
+    offset = start + isize;
+    highWater = std::max(highWater, offset);
+    return buffer + start;
+  }
+
+  /**
+   * Frees everything allocated from the arena. Anything still using the memory must be done with
+   * it.
+   */
+  void reset() noexcept {
+    offset = 0;
+  }
+
+  /**
+   * @return The number of bytes allocated since the last reset, including alignment padding.
+   */
+  std::size_t used() const noexcept {
+    return offset;
+  }
+
+  /**
+   * @return The most bytes that have been allocated at once. Use this to size the arena.
+   */
+  std::size_t getHighWaterMark() const noexcept {
+    return highWater;
+  }
+
+  /**
+   * @return The size of the buffer.
+   */
+  static constexpr std::size_t capacity() noexcept {
+    return Bytes;
+  }
+
+  protected:
+  alignas(std::max_align_t) unsigned char buffer[Bytes];
+  std::size_t offset{0};
+  std::size_t highWater{0};
+};
+
+/**
+ * A fixed number of equally sized blocks, handed out from a free list. Allocating and freeing are
+ * O(1) and never touch the heap. Unlike a FixedArena, blocks are freed one at a time, so a pool
+ * suits objects with their own lifetimes, such as those owned by shared_ptrs.
+ *
+ * The free list is guarded by a mutex, so blocks may be freed by a different task than the one
+ * which allocated them. The mutex is created with the pool, so on the brain make pools in
+ * initialize() or later rather than as globals.
+ *
+ * @tparam BlockSize The smallest size of a block. It is rounded up to alignof(std::max_align_t).
+ * @tparam BlockCount The number of blocks.
+ */
+template <std::size_t BlockSize, std::size_t BlockCount> class FixedPool {
+  public:
+  /**
+   * The size of each block.
+   */
+  static constexpr std::size_t blockSize =
+    (BlockSize + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+    alignof(std::max_align_t);
+
+  /**
+   * The number of blocks.
+   */
+  static constexpr std::size_t blockCount = BlockCount;
+
+  FixedPool() noexcept {
+    for (std::size_t i = 0; i < BlockCount; i++) {
+      next[i] = i + 1;
+    }
+  }
+
+  FixedPool(const FixedPool &) = delete;
+  FixedPool &operator=(const FixedPool &) = delete;
+
+  /**
+   * Takes a block from the pool.
+   *
+   * @return The block, or nullptr if every block is in use.
+   */
+  void *allocate() noexcept {
+    std::lock_guard<CrossplatformMutex> lock(mutex);
+    if (freeHead == BlockCount) {
+      return nullptr;
+    }
+
+    const std::size_t index = freeHead;
+    freeHead = next[index];
+    inUse++;
+    highWater = std::max(highWater, inUse);
+    return blocks + index * blockSize;
+  }
+
+  /**
+   * Returns a block to the pool.
+   *
+   * @param iblock A block from allocate().
+   */
+  void deallocate(void *iblock) noexcept {
+    const auto index =
+      static_cast<std::size_t>(static_cast<unsigned char *>(iblock) - blocks) / blockSize;
+
+    std::lock_guard<CrossplatformMutex> lock(mutex);
+    next[index] = freeHead;
+    freeHead = index;
+    inUse--;
+  }
+
+  /**
+   * @return The number of blocks in use.
+   */
+  std::size_t getInUse() const {
+    std::lock_guard<CrossplatformMutex> lock(mutex);
+    return inUse;
+  }
+
+  /**
+   * @return The most blocks that have been in use at once. Use this to size the pool.
+   */
+  std::size_t getHighWaterMark() const {
+    std::lock_guard<CrossplatformMutex> lock(mutex);
+    return highWater;
+  }
+
+  protected:
+  alignas(std::max_align_t) unsigned char blocks[blockSize * BlockCount];
+  std::array<std::size_t, BlockCount> next;
+  std::size_t freeHead{0};
+  std::size_t inUse{0};
+  std::size_t highWater{0};
+  mutable CrossplatformMutex mutex;
+};
+
+/**
+ * A standard allocator which allocates from a FixedArena, for containers which are rebuilt every
+ * cycle. Deallocating does nothing; the memory comes back when the arena is reset. Throws
+ * std::bad_alloc if the arena is full.
+ *
+ * @tparam T The type to allocate.
+ * @tparam Arena The FixedArena type.
+ */
+template <typename T, typename Arena> class ArenaAllocator {
+  public:
+  using value_type = T;
+
+  template <typename U> struct rebind { using other = ArenaAllocator<U, Arena>; };
+
+  /**
+   * @param iarena The arena to allocate from. It must outlive the allocator and anything using it.
+   */
+  explicit ArenaAllocator(Arena &iarena) noexcept : arena(&iarena) {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U, Arena> &iother) noexcept : arena(iother.getArena()) {
+  }
+
+  T *allocate(const std::size_t in) {
+    if (in > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    void *memory = arena->allocate(in * sizeof(T), alignof(T));
+    if (!memory) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(memory);
+  }
+
+  void deallocate(T *, std::size_t) noexcept {
+  }
+
+  Arena *getArena() const noexcept {
+    return arena;
+  }
+
+  template <typename U> bool operator==(const ArenaAllocator<U, Arena> &iother) const noexcept {
+    return arena == iother.getArena();
+  }
+
+  template <typename U> bool operator!=(const ArenaAllocator<U, Arena> &iother) const noexcept {
+    return arena != iother.getArena();
+  }
+
+  protected:
+  Arena *arena;
+};
+
+/**
+ * A standard allocator which allocates single objects from a FixedPool. It is meant for
+ * std::allocate_shared (see allocatePooled) and node-based containers, which allocate one object at
+ * a time. Allocating more than one object, or an object larger than a block, fails to compile or
+ * throws std::bad_alloc. So does allocating from a pool with no free blocks.
+ *
+ * @tparam T The type to allocate.
+ * @tparam Pool The FixedPool type.
+ */
+template <typename T, typename Pool> class PoolAllocator {
+  public:
+  using value_type = T;
+
+  template <typename U> struct rebind { using other = PoolAllocator<U, Pool>; };
+
+  /**
+   * @param ipool The pool to allocate from. It must outlive the allocator and anything using it.
+   */
+  explicit PoolAllocator(Pool &ipool) noexcept : pool(&ipool) {
+  }
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U, Pool> &iother) noexcept : pool(iother.getPool()) {
+  }
+
+  T *allocate(const std::size_t in) {
+    static_assert(sizeof(T) <= Pool::blockSize, "PoolAllocator: The type is larger than a block.");
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "PoolAllocator: The type is over-aligned.");
+
+    void *memory = in == 1 ? pool->allocate() : nullptr;
+    if (!memory) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(memory);
+  }
+
+  void deallocate(T *iptr, std::size_t) noexcept {
+    pool->deallocate(iptr);
+  }
+
+  Pool *getPool() const noexcept {
+    return pool;
+  }
+
+  template <typename U> bool operator==(const PoolAllocator<U, Pool> &iother) const noexcept {
+    return pool == iother.getPool();
+  }
+
+  template <typename U> bool operator!=(const PoolAllocator<U, Pool> &iother) const noexcept {
+    return pool != iother.getPool();
+  }
+
+  protected:
+  Pool *pool;
+};
+
+/**
+ * Makes a shared_ptr whose object and control block live in one block of a FixedPool, like
+ * std::make_shared but without the heap. The block goes back to the pool when the last owner lets
+ * go.
+ *
+ * @param ipool The pool. Its blocks must be large enough for T plus a shared_ptr control block;
+ * a block size too small fails to compile.
+ * @param iargs The arguments to T's constructor.
+ * @return The shared_ptr. Throws std::bad_alloc if the pool has no free blocks.
+ */
+template <typename T, typename Pool, typename... Args>
+std::shared_ptr<T> allocatePooled(Pool &ipool, Args &&... iargs) {
+  return std::allocate_shared<T>(PoolAllocator<T, Pool>(ipool), std::forward<Args>(iargs)...);
+}
+} // namespace okapi
@@ -0,0 +1,220 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace okapi {
+/**
+ * A string with a fixed capacity stored inside the object, for building messages without the
+ * heap. Text past the capacity is dropped and isTruncated() is set.
+ *
+ * Numbers are formatted by hand rather than with snprintf, because newlib's floating-point
+ * formatting allocates. FixedString has a c_str(), so it can be returned from the lambdas built
+ * by the LOG_ macros in place of a std::string:
+ *
+ * LOG_WARN(FixedString<64>("Error: ").append(error, 2));
+ *
+ * @tparam N The most characters the string can hold, not counting the terminator.
+ */
+template <std::size_t N> class FixedString {
+  public:
+  FixedString() noexcept {
+    text[0] = '\0';
+  }
+
+  /**
+   * @param istr The initial text.
+   */
+  explicit FixedString(const std::string_view istr) noexcept : FixedString() {
+    append(istr);
+  }
+
+  /**
+   * Appends text.
+   *
+   * @param istr The text.
+   * @return This string.
+   */
+  FixedString &append(const std::string_view istr) noexcept {
+    for (const char c : istr) {
+      push(c);
+    }
+    return *this;
+  }
+
+  /**
+   * Appends text.
+   *
+   * @param istr The null-terminated text.
+   * @return This string.
+   */
+  FixedString &append(const char *istr) noexcept {
+    return append(std::string_view(istr ? istr : ""));
+  }
+
+  /**
+   * Appends a character.
+   *
+   * @param ic The character.
+   * @return This string.
+   */
+  FixedString &append(const char ic) noexcept {
+    push(ic);
+    return *this;
+  }
+
+  /**
+   * Appends an integer in decimal.
+   *
+   * @param ivalue The integer.
+   * @return This string.
+   */
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+  FixedString &append(const T ivalue) noexcept {
+    if constexpr (std::is_signed_v<T>) {
+      if (ivalue < 0) {
+        push('-');
+        // Negate after widening so the most negative value doesn't overflow.
+        return appendUnsigned(std::uint64_t{0} - static_cast<std::uint64_t>(ivalue));
+      }
+    }
+    return appendUnsigned(static_cast<std::uint64_t>(ivalue));
+  }
+
+  /**
+   * Appends a floating-point number in fixed notation, like %.*f.
+   *
+   * @param ivalue The number.
+   * @param iprecision The number of digits after the decimal point, from 0 to 9.
+   * @return This string.
+   */
+  FixedString &append(const double ivalue, int iprecision = 6) noexcept {
+    if (std::isnan(ivalue)) {
+      return append("nan");
+    }
+
+    if (std::signbit(ivalue) && ivalue != 0) {
+      push('-');
+    }
+
+    if (std::isinf(ivalue)) {
+      return append("inf");
+    }
+
+    iprecision = iprecision < 0 ? 0 : (iprecision > 9 ? 9 : iprecision);
+    std::uint64_t scale = 1;
+    for (int i = 0; i < iprecision; i++) {
+      scale *= 10;
+    }
+
+    const double scaled = std::round(std::abs(ivalue) * static_cast<double>(scale));
+    if (scaled >= 1.8e19) {
+      // Too large to split into integer and fraction parts.
+      return append("ovf");
+    }
+
+    const auto fixed = static_cast<std::uint64_t>(scaled);
+    appendUnsigned(fixed / scale);
+
+    if (iprecision > 0) {
+      push('.');
+      std::uint64_t fraction = fixed % scale;
+      char digits[9];
+      for (int i = iprecision - 1; i >= 0; i--) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+      }
+      append(std::string_view(digits, static_cast<std::size_t>(iprecision)));
+    }
+
+    return *this;
+  }
+
+  /**
+   * Appends text, a character, or a number with the default precision.
+   */
+  template <typename T> FixedString &operator+=(const T &ivalue) noexcept {
+    return append(ivalue);
+  }
+
+  /**
+   * Empties the string.
+   */
+  void clear() noexcept {
+    length = 0;
+    truncated = false;
+    text[0] = '\0';
+  }
+
+  /**
+   * @return The null-terminated text.
+   */
+  const char *c_str() const noexcept {
+    return text;
+  }
+
+  /**
+   * @return The text.
+   */
+  std::string_view view() const noexcept {
+    return std::string_view(text, length);
+  }
+
+  /**
+   * @return The number of characters.
+   */
+  std::size_t size() const noexcept {
+    return length;
+  }
+
+  /**
+   * @return The most characters the string can hold.
+   */
+  static constexpr std::size_t capacity() noexcept {
+    return N;
+  }
+
+  /**
+   * @return Whether any text was dropped because the string was full.
+   */
+  bool isTruncated() const noexcept {
+    return truncated;
+  }
+
+  protected:
+  char text[N + 1];
+  std::size_t length{0};
+  bool truncated{false};
+
+  void push(const char ic) noexcept {
+    if (length < N) {
+      text[length++] = ic;
+      text[length] = '\0';
+    } else {
+      truncated = true;
+    }
+  }
+
+  FixedString &appendUnsigned(std::uint64_t ivalue) noexcept {
+    char digits[20];
+    std::size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + ivalue % 10);
+      ivalue /= 10;
+    } while (ivalue > 0);
+
+    while (count > 0) {
+      push(digits[--count]);
+    }
+    return *this;
+  }
+};
+} // namespace okapi
@@ -73,11 +73,13 @@ class Logger {
 
   template <typename T> void debug(T ilazyMessage) noexcept {
     if (isDebugLevelEnabled() && logfile && timer) {
+      char threadName[threadNameSize];
+      CrossplatformThread::getName(threadName, threadNameSize);
       std::scoped_lock lock(logfileMutex);
       fprintf(logfile,
               "%ld (%s) DEBUG: %s\n",
               static_cast<long>(timer->millis().convert(millisecond)),
-              CrossplatformThread::getName().c_str(),
+              threadName,
               ilazyMessage().c_str());
     }
   }
@@ -88,11 +90,13 @@ class Logger {
 
   template <typename T> void info(T ilazyMessage) noexcept {
     if (isInfoLevelEnabled() && logfile && timer) {
+      char threadName[threadNameSize];
+      CrossplatformThread::getName(threadName, threadNameSize);
       std::scoped_lock lock(logfileMutex);
       fprintf(logfile,
               "%ld (%s) INFO: %s\n",
               static_cast<long>(timer->millis().convert(millisecond)),
-              CrossplatformThread::getName().c_str(),
+              threadName,
               ilazyMessage().c_str());
     }
   }
@@ -103,11 +107,13 @@ class Logger {
 
   template <typename T> void warn(T ilazyMessage) noexcept {
     if (isWarnLevelEnabled() && logfile && timer) {
+      char threadName[threadNameSize];
+      CrossplatformThread::getName(threadName, threadNameSize);
       std::scoped_lock lock(logfileMutex);
       fprintf(logfile,
               "%ld (%s) WARN: %s\n",
               static_cast<long>(timer->millis().convert(millisecond)),
-              CrossplatformThread::getName().c_str(),
+              threadName,
               ilazyMessage().c_str());
     }
   }
@@ -118,11 +124,13 @@ class Logger {
 
   template <typename T> void error(T ilazyMessage) noexcept {
     if (isErrorLevelEnabled() && logfile && timer) {
+      char threadName[threadNameSize];
+      CrossplatformThread::getName(threadName, threadNameSize);
       std::scoped_lock lock(logfileMutex);
       fprintf(logfile,
               "%ld (%s) ERROR: %s\n",
               static_cast<long>(timer->millis().convert(millisecond)),
-              CrossplatformThread::getName().c_str(),
+              threadName,
               ilazyMessage().c_str());
     }
   }
@@ -151,6 +159,12 @@ class Logger {
   static void setDefaultLogger(std::shared_ptr<Logger> ilogger);
 
   private:
+  /**
+   * The longest thread name printed, including the terminator. This is the kernel's task name
+   * limit, so names are formatted on the stack instead of into a std::string.
+   */
+  static constexpr std::size_t threadNameSize = 32;
+
   const std::unique_ptr<AbstractTimer> timer;
   const LogLevel logLevel;
   FILE *logfile;
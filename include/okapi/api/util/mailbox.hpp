@@ -0,0 +1,79 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/util/seqlock.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace okapi {
+/**
+ * A latest-value mailbox for sharing state between tasks. One task publishes, any number of
+ * tasks read the newest value in O(1) without locks, allocation or blocking. Older values are
+ * overwritten, so use a MessageQueue for commands which must not be dropped.
+ *
+ * @tparam T the state type. It is copied byte-wise, so it must be trivially copyable.
+ */
+template <typename T> class Mailbox {
+  public:
+  Mailbox() = default;
+
+  /**
+   * @param ivalue The value read before anything is published.
+   */
+  explicit Mailbox(const T &ivalue) : value(ivalue) {
+  }
+
+  Mailbox(const Mailbox &) = delete;
+  Mailbox &operator=(const Mailbox &) = delete;
+
+  /**
+   * Publishes a new value. Must only be called from one task at a time.
+   *
+   * @param ivalue The new value.
+   */
+  void publish(const T &ivalue) {
+    value.write(ivalue);
+    version.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * @return The newest value.
+   */
+  T read() const {
+    return value.read();
+  }
+
+  /**
+   * Reads the newest value if it was published after the version the caller last saw.
+   *
+   * @param ioversion The version the caller last saw. Updated when a newer value is read.
+   * @param ovalue The newest value. Unchanged if there is nothing new.
+   * @return Whether a newer value was read.
+   */
+  bool readIfNewer(std::uint32_t &ioversion, T &ovalue) const {
+    const std::uint32_t current = version.load(std::memory_order_acquire);
+    if (current == ioversion) {
+      return false;
+    }
+
+    ovalue = value.read();
+    ioversion = current;
+    return true;
+  }
+
+  /**
+   * @return The number of values published. Zero means nothing has been published yet.
+   */
+  std::uint32_t getVersion() const {
+    return version.load(std::memory_order_acquire);
+  }
+
+  protected:
+  Seqlock<T> value;
+  std::atomic<std::uint32_t> version{0};
+};
+} // namespace okapi
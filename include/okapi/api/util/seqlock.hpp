@@ -0,0 +1,87 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace okapi {
+/**
+ * Publishes a value from one writer task to any number of reader tasks without locks. The writer
+ * fills the buffer readers are not using and then flips to it, so a write is one copy and two
+ * stores and never waits. Readers always get a complete value: a reader only retries if the
+ * writer published twice while it was copying, so a reader which preempts the writer is never
+ * stuck behind it, and the writer never inherits a reader's priority.
+ *
+ * @tparam T the type to publish. It is copied byte-wise, so it must be trivially copyable.
+ */
+template <typename T> class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Seqlock can only publish trivially copyable types.");
+
+  public:
+  Seqlock() = default;
+
+  /**
+   * @param ivalue The initial value.
+   */
+  explicit Seqlock(const T &ivalue) {
+    std::memcpy(&buffers[0].value, &ivalue, sizeof(T));
+  }
+
+  Seqlock(const Seqlock &) = delete;
+  Seqlock &operator=(const Seqlock &) = delete;
+
+  /**
+   * Publishes a new value. Must only be called from one task at a time.
+   *
+   * @param ivalue The new value.
+   */
+  void write(const T &ivalue) {
+    const std::uint32_t current = version.load(std::memory_order_relaxed);
+    Buffer &buffer = buffers[(current + 1) & 1];
+
+    const std::uint32_t seq = buffer.seq.load(std::memory_order_relaxed);
+    buffer.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&buffer.value, &ivalue, sizeof(T));
+    buffer.seq.store(seq + 2, std::memory_order_release);
+
+    version.store(current + 1, std::memory_order_release);
+  }
+
+  /**
+   * @return The most recently published value.
+   */
+  T read() const {
+    T out;
+    while (true) {
+      const Buffer &buffer = buffers[version.load(std::memory_order_acquire) & 1];
+      const std::uint32_t before = buffer.seq.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+
+      std::memcpy(&out, &buffer.value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (buffer.seq.load(std::memory_order_relaxed) == before) {
+        return out;
+      }
+    }
+  }
+
+  protected:
+  struct Buffer {
+    std::atomic<std::uint32_t> seq{0};
+    T value{};
+  };
+
+  Buffer buffers[2];
+  std::atomic<std::uint32_t> version{0};
+};
+} // namespace okapi
@@ -0,0 +1,65 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/chassis/controller/steppedChassisControllerPid.hpp"
+
+namespace okapi {
+class EventChassisControllerPID : public SteppedChassisControllerPID {
+  public:
+  /**
+   * A ChassisControllerPID whose task sleeps on a task notification while there is no movement
+   * and is woken as soon as one is issued, instead of polling every 10 ms. A new movement starts on
+   * the next scheduler tick rather than up to a full period later, and an idle chassis costs no
+   * CPU between autonomous moves. During a movement it steps at the same fixed period.
+   *
+   * Construct it directly and call startThread(). See ChassisControllerPID docs for the
+   * parameters.
+   */
+  EventChassisControllerPID(
+    TimeUtil itimeUtil,
+    std::shared_ptr<ChassisModel> imodel,
+    std::unique_ptr<IterativePosPIDController> idistanceController,
+    std::unique_ptr<IterativePosPIDController> iturnController,
+    std::unique_ptr<IterativePosPIDController> iangleController,
+    const AbstractMotor::GearsetRatioPair &igearset = AbstractMotor::gearset::green,
+    const ChassisScales &iscales = ChassisScales({1, 1}, imev5GreenTPR),
+    std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Stops the internal thread while this is still an EventChassisControllerPID, so the thread
+   * can't call its overrides during destruction.
+   */
+  ~EventChassisControllerPID() override;
+
+  void moveRawAsync(double itarget) override;
+
+  void moveDistanceAsync(QLength itarget) override;
+
+  void turnRawAsync(double idegTarget) override;
+
+  void turnAngleAsync(QAngle idegTarget) override;
+
+  void stop() override;
+
+  protected:
+  /**
+   * Wakes the internal thread.
+   */
+  void notifyLoop();
+
+  /**
+   * Sleeps until a movement is issued.
+   */
+  void waitIdle(AbstractRate &irate) override;
+
+  /**
+   * Clears notifications from the current movement, then sleeps until the next period.
+   */
+  void waitStep(AbstractRate &irate) override;
+};
+} // namespace okapi
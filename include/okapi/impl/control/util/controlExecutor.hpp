@@ -0,0 +1,177 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/control/controllerInput.hpp"
+#include "okapi/api/control/controllerOutput.hpp"
+#include "okapi/api/control/iterative/iterativeController.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace okapi {
+/**
+ * The phases of a control tick, in the order they run.
+ */
+enum class ControlPhase {
+  sense,    ///< Read sensors into snapshots.
+  estimate, ///< Update state estimates (odometry, filters) from the snapshots.
+  control,  ///< Step controllers on the snapshots and estimates.
+  actuate   ///< Write controller outputs to the motors.
+};
+
+struct ControlJobStats {
+  std::string name;
+  ControlPhase phase;
+
+  /**
+   * The duration of the most recent run in microseconds.
+   */
+  std::uint32_t lastTime{0};
+
+  /**
+   * The longest run duration in microseconds.
+   */
+  std::uint32_t maxTime{0};
+
+  /**
+   * The mean run duration in microseconds.
+   */
+  double meanTime{0};
+};
+
+struct ControlTickStats {
+  /**
+   * The number of ticks run.
+   */
+  std::uint32_t ticks{0};
+
+  /**
+   * The number of ticks which took longer than the period.
+   */
+  std::uint32_t overruns{0};
+
+  /**
+   * The duration of the most recent tick in microseconds.
+   */
+  std::uint32_t lastTickTime{0};
+
+  /**
+   * The longest tick duration in microseconds.
+   */
+  std::uint32_t maxTickTime{0};
+};
+
+class ControlExecutor {
+  public:
+  /**
+   * Runs registered control jobs as plain step functions in one fixed-rate task, instead of one
+   * task per controller. Every tick runs all sense jobs, then all estimate jobs, then all control
+   * jobs, then all actuate jobs, each in the order they were added. Sensors are therefore read
+   * once per tick, back to back, and every controller sees the same snapshot. Each job is timed
+   * so the CPU cost of every controller can be measured on the robot.
+   *
+   * Jobs can only be added while the executor is stopped.
+   *
+   * @param iperiod The tick period. The minimum is 1 ms.
+   * @param ipriority The task priority.
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit ControlExecutor(const QTime &iperiod = 10_ms,
+                           std::uint32_t ipriority = TASK_PRIORITY_MAX - 1,
+                           const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~ControlExecutor();
+
+  ControlExecutor(const ControlExecutor &) = delete;
+  ControlExecutor(ControlExecutor &&other) = delete;
+  ControlExecutor &operator=(const ControlExecutor &other) = delete;
+  ControlExecutor &operator=(ControlExecutor &&other) = delete;
+
+  /**
+   * Adds a job.
+   *
+   * @param iphase The phase to run the job in.
+   * @param iname The name used in the job's stats.
+   * @param istep The step function.
+   * @return Whether the job was added. False if the executor is running, or if it was stopped
+   * and its last tick hasn't returned yet.
+   */
+  bool add(ControlPhase iphase, const std::string &iname, std::function<void()> istep);
+
+  /**
+   * Adds an iterative controller as three jobs: its input is read in the sense phase, it is
+   * stepped on that reading in the control phase, and its output is written in the actuate phase.
+   * Use this in place of the matching AsyncWrapper, which would run the controller in its own
+   * task.
+   *
+   * @param iname The name used in the jobs' stats.
+   * @param icontroller The controller.
+   * @param iinput The controller's input.
+   * @param ioutput The controller's output.
+   * @return Whether the jobs were added. False if the executor is running, or if it was stopped
+   * and its last tick hasn't returned yet.
+   */
+  bool addController(const std::string &iname,
+                     const std::shared_ptr<IterativeController<double, double>> &icontroller,
+                     const std::shared_ptr<ControllerInput<double>> &iinput,
+                     const std::shared_ptr<ControllerOutput<double>> &ioutput);
+
+  /**
+   * Starts the task. Does nothing if it is already running, or if it was stopped and its last tick
+   * hasn't returned yet.
+   */
+  void start();
+
+  /**
+   * Stops the task after its current tick. Does nothing if it is not running. Can be called from
+   * a job.
+   */
+  void stop();
+
+  /**
+   * @return Whether the task is running.
+   */
+  bool isRunning() const;
+
+  /**
+   * @return The timing statistics of every job, in run order, gathered since the executor was
+   * started.
+   */
+  std::vector<ControlJobStats> getJobStats() const;
+
+  /**
+   * @return The tick timing statistics gathered since the executor was started.
+   */
+  ControlTickStats getTickStats() const;
+
+  protected:
+  struct Job {
+    std::function<void()> step;
+    ControlJobStats stats;
+  };
+
+  std::shared_ptr<Logger> logger;
+  std::uint32_t period;
+  std::uint32_t priority;
+  std::vector<Job> jobs;
+  std::vector<std::uint32_t> durations;
+  mutable CrossplatformMutex statsMutex;
+  ControlTickStats tickStats;
+  PeriodicTask task;
+
+  /**
+   * Runs every job once and publishes their durations. Called by the task every period.
+   */
+  void tick();
+};
+} // namespace okapi
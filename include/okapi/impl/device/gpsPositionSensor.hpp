@@ -0,0 +1,41 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/device/absolutePositionSensor.hpp"
+
+namespace okapi {
+class GpsPositionSensor : public AbsolutePositionSensor {
+  public:
+  /**
+   * A V5 GPS sensor used as an absolute position source. Fixes whose reported error is above
+   * ``imaxError`` are discarded. The sensor reports in StateMode::CARTESIAN, and fixes are
+   * converted to StateMode::FRAME_TRANSFORMATION.
+   *
+   * @param iport The port number in the range ``[1, 21]``.
+   * @param imaxError The largest reported error for which a fix is still used.
+   */
+  GpsPositionSensor(std::uint8_t iport, const QLength &imaxError = 5_cm);
+
+  /**
+   * Get the newest position fix.
+   *
+   * @return the newest position fix.
+   */
+  PositionFix getFix() override;
+
+  /**
+   * The data rate the sensor is configured with, in milliseconds.
+   */
+  static constexpr std::uint32_t dataRate = 20;
+
+  protected:
+  std::uint8_t port;
+  QLength maxError;
+  std::uint32_t lastFixTime{0};
+};
+} // namespace okapi
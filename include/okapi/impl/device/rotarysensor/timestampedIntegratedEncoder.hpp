@@ -0,0 +1,37 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/device/rotarysensor/timestampedRotarySensor.hpp"
+#include "okapi/impl/device/rotarysensor/integratedEncoder.hpp"
+
+namespace okapi {
+class TimestampedIntegratedEncoder : public IntegratedEncoder, public TimestampedRotarySensor {
+  public:
+  /**
+   * Integrated motor encoder which also reports the time the motor sampled its encoder.
+   *
+   * @param imotor The motor to use the encoder from.
+   */
+  TimestampedIntegratedEncoder(const okapi::Motor &imotor);
+
+  /**
+   * Integrated motor encoder which also reports the time the motor sampled its encoder.
+   *
+   * @param iport The motor's port number in the range [1, 21].
+   * @param ireversed Whether the encoder is reversed.
+   */
+  TimestampedIntegratedEncoder(std::int8_t iport, bool ireversed = false);
+
+  /**
+   * Get the raw encoder count together with the time the motor sampled it.
+   *
+   * @return the raw encoder count and its sample time, or a value of ``PROS_ERR`` on a failure.
+   */
+  TimestampedReading getTimestamped() const override;
+};
+} // namespace okapi
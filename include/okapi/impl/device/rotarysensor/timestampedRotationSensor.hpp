@@ -0,0 +1,42 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/device/rotarysensor/timestampedRotarySensor.hpp"
+#include "okapi/impl/device/rotarysensor/rotationSensor.hpp"
+
+namespace okapi {
+class TimestampedRotationSensor : public RotationSensor, public TimestampedRotarySensor {
+  public:
+  /**
+   * A rotation sensor in a V5 port which also reports when its value was sampled. The sensor's
+   * data rate is raised to its 5 ms minimum so that it keeps up with a high-rate odometry task.
+   *
+   * The rotation sensor does not report a device timestamp, so the sample time is taken as the
+   * time of the read rounded down to a multiple of the data rate. This bounds the error to one
+   * sample period. Reads within the same period report the same timestamp, so a consumer sees them
+   * as one sample.
+   *
+   * @param iport The port number in the range ``[1, 21]``.
+   * @param ireversed Whether the sensor is reversed. This will set the reversed state in the
+   * kernel.
+   */
+  TimestampedRotationSensor(std::uint8_t iport, bool ireversed = false);
+
+  /**
+   * Get the position in degrees together with the time it was sampled.
+   *
+   * @return the position in degrees and its sample time, or a value of ``PROS_ERR`` on a failure.
+   */
+  TimestampedReading getTimestamped() const override;
+
+  /**
+   * The data rate the sensor is configured with, in milliseconds.
+   */
+  static constexpr std::uint32_t dataRate = 5;
+};
+} // namespace okapi
@@ -0,0 +1,107 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/odometry/odometry.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include <memory>
+
+namespace okapi {
+struct OdometryStepStats {
+  /**
+   * The number of steps run.
+   */
+  std::uint32_t steps{0};
+
+  /**
+   * The number of steps which took longer than the task period.
+   */
+  std::uint32_t overruns{0};
+
+  /**
+   * The duration of the most recent step in microseconds.
+   */
+  std::uint32_t lastStepTime{0};
+
+  /**
+   * The longest step duration in microseconds.
+   */
+  std::uint32_t maxStepTime{0};
+
+  /**
+   * The mean step duration in microseconds.
+   */
+  double meanStepTime{0};
+};
+
+class OdometryTask {
+  public:
+  /**
+   * Runs an Odometry in a dedicated task at a fixed period. The task runs above the default
+   * priority so that controller and user tasks can't delay odometry samples. Each step is timed
+   * so the cost of the odometry implementation can be measured on the robot.
+   *
+   * @param iodometry The odometry to step.
+   * @param iperiod The step period. The minimum is 1 ms; 5 ms matches the V5 device update rate.
+   * @param ipriority The task priority.
+   * @param ilogger The logger this instance will log to.
+   */
+  OdometryTask(const std::shared_ptr<Odometry> &iodometry,
+               const QTime &iperiod = 5_ms,
+               std::uint32_t ipriority = TASK_PRIORITY_MAX - 2,
+               const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~OdometryTask();
+
+  OdometryTask(const OdometryTask &) = delete;
+  OdometryTask(OdometryTask &&other) = delete;
+  OdometryTask &operator=(const OdometryTask &other) = delete;
+  OdometryTask &operator=(OdometryTask &&other) = delete;
+
+  /**
+   * Starts the task. Does nothing if it is already running.
+   */
+  void start();
+
+  /**
+   * Stops the task after its current step. Does nothing if it is not running.
+   */
+  void stop();
+
+  /**
+   * @return Whether the task is running.
+   */
+  bool isRunning() const;
+
+  /**
+   * @return The step timing statistics gathered since the task was started.
+   */
+  OdometryStepStats getStepStats() const;
+
+  /**
+   * @return The odometry being stepped.
+   */
+  std::shared_ptr<Odometry> getOdometry() const;
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  std::shared_ptr<Odometry> odom;
+  std::uint32_t period;
+  std::uint32_t priority;
+  mutable CrossplatformMutex statsMutex;
+  OdometryStepStats stats;
+  PeriodicTask task;
+
+  /**
+   * Steps the odometry once and records the step's duration. Called by the task every period.
+   */
+  void step();
+};
+} // namespace okapi
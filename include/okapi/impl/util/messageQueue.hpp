@@ -0,0 +1,215 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/util/logging.hpp"
+#include "pros/apix.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace okapi {
+/**
+ * A fixed-size queue of messages between tasks, on PROS queues. Messages live in a pool owned by
+ * the queue and only their slot indices go through the PROS queues, so a message is written in
+ * place by the producer and read in place by the consumer without being copied, and nothing is
+ * allocated after construction. Producers never block: when every slot is in use, acquire() and
+ * send() fail instead.
+ *
+ * Any number of tasks can produce and consume.
+ *
+ * @tparam T the message type
+ * @tparam n the number of messages which can be in flight at once. At most 65535.
+ */
+template <typename T, std::size_t n> class MessageQueue {
+  static_assert(n > 0 && n <= UINT16_MAX, "MessageQueue needs between 1 and 65535 slots.");
+
+  public:
+  /**
+   * Throws a `std::runtime_error` exception if the PROS queues can't be created.
+   *
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit MessageQueue(std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger())
+    : logger(std::move(ilogger)),
+      freeSlots(pros::c::queue_create(n, sizeof(std::uint16_t))),
+      readySlots(pros::c::queue_create(n, sizeof(std::uint16_t))) {
+    bool filled = freeSlots != nullptr && readySlots != nullptr;
+    for (std::size_t i = 0; filled && i < n; i++) {
+      const auto slot = static_cast<std::uint16_t>(i);
+      filled = pros::c::queue_append(freeSlots, &slot, 0);
+    }
+
+    if (!filled) {
+      deleteQueues();
+      std::string msg = "MessageQueue: Failed to create the PROS queues.";
+      LOG_ERROR(msg);
+      throw std::runtime_error(msg);
+    }
+  }
+
+  ~MessageQueue() {
+    deleteQueues();
+  }
+
+  MessageQueue(const MessageQueue &) = delete;
+  MessageQueue &operator=(const MessageQueue &) = delete;
+
+  /**
+   * Takes a free message slot to write into. Pass it to publish() when it is filled in.
+   *
+   * @return The slot, or nullptr if every slot is in use.
+   */
+  T *acquire() {
+    std::uint16_t slot;
+    if (!pros::c::queue_recv(freeSlots, &slot, 0)) {
+      return nullptr;
+    }
+    return &pool[slot];
+  }
+
+  /**
+   * Queues a slot from acquire() for the consumer. If it can't be queued, it goes back to the pool
+   * and the message is dropped.
+   *
+   * @param imessage The slot.
+   * @return Whether it was queued.
+   */
+  bool publish(T *imessage) {
+    std::uint16_t slot;
+    if (!toSlot(imessage, slot)) {
+      return false;
+    }
+
+    if (pros::c::queue_append(readySlots, &slot, 0)) {
+      return true;
+    }
+
+    LOG_ERROR("MessageQueue: Failed to queue slot " + std::to_string(slot) +
+              ", dropping the message.");
+    returnSlot(slot);
+    return false;
+  }
+
+  /**
+   * Waits for the oldest queued message. Pass it to release() when done with it.
+   *
+   * @param itimeout The maximum time to wait in milliseconds. Zero returns immediately.
+   * @return The message, or nullptr if none arrived in time.
+   */
+  T *receive(const std::uint32_t itimeout = 0) {
+    std::uint16_t slot;
+    if (!pros::c::queue_recv(readySlots, &slot, itimeout)) {
+      return nullptr;
+    }
+    return &pool[slot];
+  }
+
+  /**
+   * Returns a slot from receive() to the pool.
+   *
+   * @param imessage The slot.
+   */
+  void release(T *imessage) {
+    std::uint16_t slot;
+    if (toSlot(imessage, slot)) {
+      returnSlot(slot);
+    }
+  }
+
+  /**
+   * Copies a message into a free slot and queues it.
+   *
+   * @param imessage The message.
+   * @return Whether it was queued. False if every slot is in use.
+   */
+  bool send(const T &imessage) {
+    T *slot = acquire();
+    if (slot == nullptr) {
+      return false;
+    }
+
+    *slot = imessage;
+    return publish(slot);
+  }
+
+  /**
+   * Waits for the oldest queued message and copies it out.
+   *
+   * @param omessage The message.
+   * @param itimeout The maximum time to wait in milliseconds. Zero returns immediately.
+   * @return Whether a message was received.
+   */
+  bool receive(T &omessage, const std::uint32_t itimeout) {
+    T *slot = receive(itimeout);
+    if (slot == nullptr) {
+      return false;
+    }
+
+    omessage = *slot;
+    release(slot);
+    return true;
+  }
+
+  /**
+   * @return The number of queued messages.
+   */
+  std::uint32_t getWaiting() const {
+    return pros::c::queue_get_waiting(readySlots);
+  }
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  std::array<T, n> pool{};
+  pros::c::queue_t freeSlots;
+  pros::c::queue_t readySlots;
+
+  /**
+   * Finds the slot index of a message.
+   *
+   * @param imessage The message.
+   * @param oslot The slot index.
+   * @return Whether the message is in the pool.
+   */
+  bool toSlot(const T *imessage, std::uint16_t &oslot) {
+    if (imessage < pool.data() || imessage >= pool.data() + n) {
+      LOG_ERROR_S("MessageQueue: The message is not from this queue.");
+      return false;
+    }
+
+    oslot = static_cast<std::uint16_t>(imessage - pool.data());
+    return true;
+  }
+
+  /**
+   * Returns a slot to the free queue. The free queue holds every slot, so this only fails if a
+   * slot is released twice.
+   *
+   * @param islot The slot index.
+   */
+  void returnSlot(const std::uint16_t islot) {
+    if (!pros::c::queue_append(freeSlots, &islot, 0)) {
+      LOG_ERROR("MessageQueue: Failed to return slot " + std::to_string(islot) +
+                " to the pool. Was it released twice?");
+    }
+  }
+
+  void deleteQueues() {
+    if (freeSlots) {
+      pros::c::queue_delete(freeSlots);
+      freeSlots = nullptr;
+    }
+    if (readySlots) {
+      pros::c::queue_delete(readySlots);
+      readySlots = nullptr;
+    }
+  }
+};
+} // namespace okapi
@@ -0,0 +1,94 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace okapi {
+class PeriodicTask {
+  public:
+  /**
+   * Runs a job in its own task on a fixed grid of release times, like task_delay_until, so the
+   * period doesn't drift by the job's run time. A job which overruns is released again at once.
+   *
+   * The task waits for the next release on its notification, so stop() wakes it immediately
+   * instead of polling. stop() can be called from any task, including from the job itself, in
+   * which case the loop ends after the job returns.
+   */
+  PeriodicTask();
+
+  /**
+   * Stops the task. Must not be called from the job, or while another task is in stop().
+   */
+  ~PeriodicTask();
+
+  PeriodicTask(const PeriodicTask &) = delete;
+  PeriodicTask(PeriodicTask &&other) = delete;
+  PeriodicTask &operator=(const PeriodicTask &other) = delete;
+  PeriodicTask &operator=(PeriodicTask &&other) = delete;
+
+  /**
+   * Starts the task. Does nothing if it is already running, if it was stopped from its own job
+   * which hasn't returned yet, or while another task is still waiting in stop().
+   *
+   * @param iname The task name.
+   * @param iperiod The period in ms. The minimum is 1 ms.
+   * @param ipriority The task priority.
+   * @param ijob The job, called with its release time in ms.
+   * @param istackDepth The task's stack depth.
+   * @return Whether the task was started.
+   */
+  bool start(const std::string &iname,
+             std::uint32_t iperiod,
+             std::uint32_t ipriority,
+             std::function<void(std::uint32_t)> ijob,
+             std::uint16_t istackDepth = TASK_STACK_DEPTH_DEFAULT);
+
+  /**
+   * Stops the task after its current job. Does nothing if it is not running. When called from
+   * another task, blocks until the job has returned. When called from the job, returns at once.
+   * Any number of tasks can wait at the same time. The caller's task notification is not used.
+   */
+  void stop();
+
+  /**
+   * @return Whether the task is running and hasn't been asked to stop.
+   */
+  bool isRunning() const;
+
+  /**
+   * @return Whether the loop hasn't exited yet. Unlike isRunning(), this stays true after stop()
+   * until the current job has returned.
+   */
+  bool isActive() const;
+
+  protected:
+  std::string name;
+  std::uint32_t period{1};
+  std::function<void(std::uint32_t)> job;
+  CrossplatformThread *thread{nullptr};
+  std::atomic_bool running{false};
+
+  // Guards the loop's lifetime, so a task stopping the loop can't miss its exit.
+  mutable CrossplatformMutex stateMutex;
+  pros::task_t loopTask{nullptr};
+  bool loopActive{false};
+
+  // Taken by start() and given back by the loop as its last action. Tasks in stop() wait for it
+  // and give it straight back, so every one of them is released.
+  pros::c::sem_t idle;
+  std::size_t waiters{0};
+
+  static void trampoline(void *context);
+  void loop();
+};
+} // namespace okapi
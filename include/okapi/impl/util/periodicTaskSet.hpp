@@ -0,0 +1,194 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace okapi {
+struct DeadlineMiss {
+  /**
+   * The name of the task which missed its deadline.
+   */
+  std::string name;
+
+  /**
+   * The time the job should have been released, in microseconds.
+   */
+  std::uint64_t release{0};
+
+  /**
+   * How long after its release the job finished, in microseconds.
+   */
+  std::uint32_t responseTime{0};
+
+  /**
+   * The task's deadline, in microseconds.
+   */
+  std::uint32_t deadline{0};
+};
+
+struct PeriodicTaskStats {
+  /**
+   * The number of histogram buckets. Bucket i counts durations in [2^i, 2^(i+1)) microseconds;
+   * the first bucket also counts zero and the last also counts everything longer.
+   */
+  static constexpr std::size_t buckets = 18;
+
+  std::string name;
+  std::uint32_t period{0};
+  std::uint32_t priority{0};
+
+  /**
+   * The number of jobs run.
+   */
+  std::uint32_t runs{0};
+
+  /**
+   * The number of jobs which finished after their deadline.
+   */
+  std::uint32_t deadlineMisses{0};
+
+  /**
+   * The longest job execution time in microseconds.
+   */
+  std::uint32_t maxExecTime{0};
+
+  /**
+   * The mean job execution time in microseconds.
+   */
+  double meanExecTime{0};
+
+  /**
+   * The longest release jitter (how late a job started) in microseconds.
+   */
+  std::uint32_t maxJitter{0};
+
+  std::array<std::uint32_t, buckets> execHistogram{};
+  std::array<std::uint32_t, buckets> jitterHistogram{};
+};
+
+class PeriodicTaskSet {
+  public:
+  /**
+   * A set of periodic tasks with rate-monotonic priorities: the shorter a task's period, the
+   * higher its priority. Each task runs its job in a PeriodicTask, so it is released on a
+   * fixed grid instead of drifting by the job's run time. The execution time and release jitter
+   * of every job are recorded in histograms, and a job which finishes after its deadline raises a
+   * deadline miss event.
+   *
+   * Priorities are assigned from ihighestPriority down to ilowestPriority in order of period when
+   * the set is started. Tasks with equal periods share a priority.
+   *
+   * @param ihighestPriority The priority of the task with the shortest period.
+   * @param ilowestPriority The lowest priority to assign.
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit PeriodicTaskSet(std::uint32_t ihighestPriority = TASK_PRIORITY_MAX - 2,
+                           std::uint32_t ilowestPriority = TASK_PRIORITY_DEFAULT,
+                           const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~PeriodicTaskSet();
+
+  PeriodicTaskSet(const PeriodicTaskSet &) = delete;
+  PeriodicTaskSet(PeriodicTaskSet &&other) = delete;
+  PeriodicTaskSet &operator=(const PeriodicTaskSet &other) = delete;
+  PeriodicTaskSet &operator=(PeriodicTaskSet &&other) = delete;
+
+  /**
+   * Adds a task. Tasks can only be added while the set is stopped.
+   *
+   * @param iname The task name.
+   * @param iperiod The period. The minimum is 1 ms.
+   * @param ijob The job run every period.
+   * @param ideadline The deadline relative to each release. Zero means the period.
+   * @param istackDepth The task's stack depth.
+   * @return Whether the task was added. False if the set is running.
+   */
+  bool add(const std::string &iname,
+           const QTime &iperiod,
+           std::function<void()> ijob,
+           const QTime &ideadline = 0_ms,
+           std::uint16_t istackDepth = TASK_STACK_DEPTH_DEFAULT);
+
+  /**
+   * Sets the function called when a job misses its deadline. It is called from the task which
+   * missed, so it must be short. By default misses are logged.
+   *
+   * @param icallback The callback.
+   */
+  void onDeadlineMiss(std::function<void(const DeadlineMiss &)> icallback);
+
+  /**
+   * Assigns priorities and starts every task. Does nothing if the set is already running. Warns
+   * if the measured utilization of a previous run exceeds the rate-monotonic bound.
+   */
+  void start();
+
+  /**
+   * Stops every task after its current job. Does nothing if the set is not running. Can be called
+   * from a job.
+   */
+  void stop();
+
+  /**
+   * @return Whether the set is running.
+   */
+  bool isRunning() const;
+
+  /**
+   * @return The statistics of every task, gathered since the set was started.
+   */
+  std::vector<PeriodicTaskStats> getStats() const;
+
+  /**
+   * @return The sum of mean execution time over period for every task.
+   */
+  double getUtilization() const;
+
+  /**
+   * @param inumTasks The number of tasks.
+   * @return The Liu-Layland utilization bound n(2^(1/n) - 1). A set below it always meets its
+   * deadlines under rate-monotonic priorities.
+   */
+  static double utilizationBound(std::size_t inumTasks);
+
+  protected:
+  struct Entry {
+    std::function<void()> job;
+    std::uint32_t deadline;
+    std::uint16_t stackDepth;
+    PeriodicTaskStats stats;
+    PeriodicTask task;
+  };
+
+  std::shared_ptr<Logger> logger;
+  std::uint32_t highestPriority;
+  std::uint32_t lowestPriority;
+  std::vector<std::unique_ptr<Entry>> entries;
+  std::function<void(const DeadlineMiss &)> missCallback;
+  std::atomic_bool running{false};
+  mutable CrossplatformMutex statsMutex;
+
+  /**
+   * Runs an entry's job once and records its timing. Called by the entry's task every period.
+   *
+   * @param ientry The entry.
+   * @param irelease The time the job was released, in ms.
+   */
+  void runJob(Entry &ientry, std::uint32_t irelease);
+  static std::size_t bucket(std::uint32_t iduration);
+};
+} // namespace okapi
@@ -0,0 +1,51 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/impl/util/timeUtilFactory.hpp"
+
+namespace okapi {
+/**
+ * A TimeUtilFactory that supplies a PredictiveSettledUtil with the parameters passed in the
+ * constructor to every new TimeUtil instance. Give the TimeUtil to each controller which should
+ * settle early; controllers built with other TimeUtils keep the SettledUtil rules.
+ */
+class PredictiveTimeUtilFactory : public TimeUtilFactory {
+  public:
+  /**
+   * See PredictiveSettledUtil docs.
+   */
+  PredictiveTimeUtilFactory(double iatTargetError = 50,
+                            double iatTargetDerivative = 5,
+                            const QTime &iatTargetTime = 250_ms,
+                            const QTime &ipredictionHorizon = 100_ms,
+                            double icaptureError = 0);
+
+  /**
+   * Creates a TimeUtil with the PredictiveSettledUtil parameters specified in the constructor by
+   * delegating to PredictiveTimeUtilFactory::withPredictiveSettledUtilParams.
+   *
+   * @return A TimeUtil with the PredictiveSettledUtil parameters specified in the constructor.
+   */
+  TimeUtil create() override;
+
+  /**
+   * Creates a TimeUtil with a PredictiveSettledUtil. See PredictiveSettledUtil docs.
+   */
+  static TimeUtil withPredictiveSettledUtilParams(double iatTargetError = 50,
+                                                  double iatTargetDerivative = 5,
+                                                  const QTime &iatTargetTime = 250_ms,
+                                                  const QTime &ipredictionHorizon = 100_ms,
+                                                  double icaptureError = 0);
+
+  private:
+  double atTargetError;
+  double atTargetDerivative;
+  QTime atTargetTime;
+  QTime predictionHorizon;
+  double captureError;
+};
+} // namespace okapi
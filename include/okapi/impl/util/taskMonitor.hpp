@@ -0,0 +1,165 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace okapi {
+struct TaskSample {
+  std::string name;
+  pros::task_t handle{nullptr};
+  pros::task_state_e_t state{pros::E_TASK_STATE_INVALID};
+  std::uint32_t priority{0};
+
+  /**
+   * The stack depth in words, if known. Zero if unknown.
+   */
+  std::uint32_t stackDepth{0};
+
+  /**
+   * The least free stack the task has ever had, in words. -1 if the kernel doesn't provide it.
+   */
+  std::int32_t stackHighWater{-1};
+
+  /**
+   * The task's run-time counter. Zero if the kernel doesn't provide it.
+   */
+  std::uint32_t runTime{0};
+
+  /**
+   * The share of CPU time the task used since the previous sample, from 0 to 1. -1 if the kernel
+   * doesn't provide run-time counters or there is no previous sample.
+   */
+  double cpu{-1};
+};
+
+class TaskMonitor {
+  public:
+  /**
+   * Samples the state, priority, stack high-water mark, and CPU share of PROS tasks, to find tasks
+   * which are close to overflowing their stacks and tasks which use the most CPU. Results are
+   * available through getSamples(), as a serial dump with dump(), and as a page on the LLEMU screen
+   * with printPage().
+   *
+   * PROS doesn't publish the RTOS's task statistics in its headers, so the FreeRTOS functions are
+   * bound weakly. If the kernel exports uxTaskGetSystemState, every task is sampled, including run
+   * times. Otherwise only the watched tasks are sampled, with stack high-water marks if the kernel
+   * exports uxTaskGetStackHighWaterMark. The PROS competition tasks are watched by default.
+   *
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit TaskMonitor(const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~TaskMonitor();
+
+  TaskMonitor(const TaskMonitor &) = delete;
+  TaskMonitor(TaskMonitor &&other) = delete;
+  TaskMonitor &operator=(const TaskMonitor &other) = delete;
+  TaskMonitor &operator=(TaskMonitor &&other) = delete;
+
+  /**
+   * Watches a task by name. The name is looked up on every sample, so the task doesn't need to
+   * exist yet. Also records the stack depth of any task with this name which is sampled.
+   *
+   * @param iname The task name.
+   * @param istackDepth The stack depth the task was created with, in words.
+   */
+  void watch(const std::string &iname, std::uint32_t istackDepth = TASK_STACK_DEPTH_DEFAULT);
+
+  /**
+   * Takes a sample of every task now. This is also what the monitor task does every period.
+   *
+   * @return The sample of every task found.
+   */
+  std::vector<TaskSample> sample();
+
+  /**
+   * @return The latest sample.
+   */
+  std::vector<TaskSample> getSamples() const;
+
+  /**
+   * Starts a task which samples every period.
+   *
+   * @param iperiod The sampling period.
+   * @param ipriority The monitor task's priority.
+   */
+  void start(const QTime &iperiod = 1000_ms, std::uint32_t ipriority = TASK_PRIORITY_MIN + 1);
+
+  /**
+   * Stops the monitor task after its current sample.
+   */
+  void stop();
+
+  /**
+   * Writes the latest sample as a table. stdout is the serial port on the brain.
+   *
+   * @param ifile The file to write to.
+   */
+  void dump(FILE *ifile = stdout) const;
+
+  /**
+   * Prints a page of the latest sample to the LLEMU screen, seven tasks per page below a header.
+   * LLEMU must be initialized.
+   *
+   * @param ipage The page number, wrapped to the number of pages.
+   */
+  void printPage(std::size_t ipage) const;
+
+  /**
+   * @return Whether the kernel exports uxTaskGetSystemState, so every task and its run time can be
+   * sampled.
+   */
+  static bool hasSystemState();
+
+  /**
+   * @return Whether the kernel exports uxTaskGetStackHighWaterMark.
+   */
+  static bool hasStackHighWater();
+
+  /**
+   * The number of tasks shown on a page by printPage.
+   */
+  static constexpr std::size_t tasksPerPage = 7;
+
+  protected:
+  struct Watched {
+    std::string name;
+    std::uint32_t stackDepth;
+  };
+
+  std::shared_ptr<Logger> logger;
+  std::vector<Watched> watched;
+  std::vector<TaskSample> samples;
+  std::uint32_t lastTotalRunTime{0};
+  mutable CrossplatformMutex samplesMutex;
+  PeriodicTask monitorTask;
+
+  /**
+   * @param iname The task name.
+   * @return The stack depth watched for the task, or zero.
+   */
+  std::uint32_t watchedStackDepth(const char *iname) const;
+
+  /**
+   * Fills in the CPU share of each sample from the previous samples' run times. Must be called with
+   * samplesMutex held.
+   *
+   * @param isamples The new samples.
+   * @param itotalRunTime The total run time of the new sample.
+   */
+  void computeCpu(std::vector<TaskSample> &isamples, std::uint32_t itotalRunTime) const;
+};
+} // namespace okapi
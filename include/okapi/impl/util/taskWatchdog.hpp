@@ -0,0 +1,206 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "api.h"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/device/motor/abstractMotor.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/impl/util/periodicTask.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace okapi {
+struct WatchdogFault {
+  /**
+   * The name the task was registered with.
+   */
+  std::string name;
+
+  /**
+   * When the fault was raised, in milliseconds since the program started.
+   */
+  std::uint32_t time{0};
+
+  /**
+   * How long the task had gone without checking in, in milliseconds.
+   */
+  std::uint32_t silence{0};
+
+  /**
+   * The task's timeout, in milliseconds.
+   */
+  std::uint32_t timeout{0};
+};
+
+class TaskWatchdog {
+  public:
+  /**
+   * The most tasks which can be registered.
+   */
+  static constexpr std::size_t maxTasks = 16;
+
+  /**
+   * The number of fault records kept. Older records are overwritten.
+   */
+  static constexpr std::size_t maxFaults = 16;
+
+  /**
+   * A watchdog for periodic tasks. Each registered task checks in every cycle. If a task goes
+   * longer than its timeout without checking in, the watchdog suspends it (so a wedged loop can't
+   * keep commanding its motors), puts its motors in their safe state, and records a fault. If the
+   * task later checks in again the fault is cleared, but the task stays suspended until resumed.
+   *
+   * Checking in is one store of the time to an atomic, so it costs well under a microsecond.
+   *
+   * @param icheckPeriod How often the watchdog checks for missed heartbeats.
+   * @param ipriority The watchdog task's priority. It must be strictly higher than the tasks it
+   * watches, so the default is the highest priority, above the defaults of ControlExecutor,
+   * OdometryTask, and PeriodicTaskSet.
+   * @param ilogger The logger this instance will log to.
+   */
+  explicit TaskWatchdog(const QTime &icheckPeriod = 10_ms,
+                        std::uint32_t ipriority = TASK_PRIORITY_MAX,
+                        const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  ~TaskWatchdog();
+
+  TaskWatchdog(const TaskWatchdog &) = delete;
+  TaskWatchdog(TaskWatchdog &&other) = delete;
+  TaskWatchdog &operator=(const TaskWatchdog &other) = delete;
+  TaskWatchdog &operator=(TaskWatchdog &&other) = delete;
+
+  /**
+   * Registers the calling task, or updates its registration if the name is already registered,
+   * for tasks such as opcontrol which are restarted. The task must check in before its timeout
+   * passes.
+   *
+   * @param iname The name to register under.
+   * @param itimeout The longest the task may go without checking in.
+   * @param isafeState The function which puts the task's motors in their safe state. It runs in
+   * the watchdog task, so it must not capture anything on the watched task's stack.
+   * @param isuspend Whether to suspend the task when it misses its heartbeat.
+   * @return The id to check in with. Throws std::out_of_range if maxTasks are registered.
+   */
+  std::size_t registerTask(const std::string &iname,
+                           const QTime &itimeout,
+                           std::function<void()> isafeState,
+                           bool isuspend = true);
+
+  /**
+   * Records a heartbeat for a task.
+   *
+   * @param iid The id returned by registerTask.
+   */
+  void checkIn(std::size_t iid) {
+    if (iid < maxTasks) {
+      entries[iid].lastBeat.store(pros::millis(), std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Stops watching a task, for example before it finishes or blocks on purpose.
+   *
+   * @param iid The id returned by registerTask.
+   */
+  void disable(std::size_t iid);
+
+  /**
+   * Starts watching a task again. The task counts as having just checked in.
+   *
+   * @param iid The id returned by registerTask.
+   */
+  void enable(std::size_t iid);
+
+  /**
+   * @param iid The id returned by registerTask.
+   * @return Whether the task has missed its heartbeat and not checked in since.
+   */
+  bool isFaulted(std::size_t iid) const;
+
+  /**
+   * @return The most recent fault records, oldest first.
+   */
+  std::vector<WatchdogFault> getFaults() const;
+
+  /**
+   * @return The number of faults raised since the watchdog was made.
+   */
+  std::uint32_t getFaultCount() const;
+
+  /**
+   * Starts the watchdog task. Does nothing if it is already running.
+   */
+  void start();
+
+  /**
+   * Stops the watchdog task after its current check. Does nothing if it is not running.
+   */
+  void stop();
+
+  /**
+   * Makes a safe state which sets a brake mode on PROS motors and stops them. The motors are
+   * copied, so they can be locals of the watched task.
+   *
+   * @param imotors The motors.
+   * @param ibrakeMode The brake mode, such as coast, brake, or hold.
+   * @return The safe state.
+   */
+  static std::function<void()> stopMotors(std::vector<pros::Motor> imotors,
+                                          pros::motor_brake_mode_e_t ibrakeMode);
+
+  /**
+   * Makes a safe state which sets a brake mode on okapi motors and stops them.
+   *
+   * @param imotors The motors.
+   * @param ibrakeMode The brake mode, such as coast, brake, or hold.
+   * @return The safe state.
+   */
+  static std::function<void()> stopMotors(std::vector<std::shared_ptr<AbstractMotor>> imotors,
+                                          AbstractMotor::brakeMode ibrakeMode);
+
+  protected:
+  struct Entry {
+    std::string name;
+    pros::task_t task{nullptr};
+    std::uint32_t timeout{0};
+    std::function<void()> safeState;
+    bool suspend{true};
+    std::atomic<std::uint32_t> lastBeat{0};
+    std::atomic_bool enabled{false};
+    std::atomic_bool faulted{false};
+  };
+
+  std::shared_ptr<Logger> logger;
+  std::uint32_t checkPeriod;
+  std::uint32_t priority;
+  std::array<Entry, maxTasks> entries;
+  std::atomic<std::size_t> entryCount{0};
+  std::array<WatchdogFault, maxFaults> faults;
+  std::uint32_t faultCount{0};
+  mutable CrossplatformMutex mutex;
+  PeriodicTask task;
+
+  /**
+   * Checks one task and raises or clears its fault.
+   *
+   * @param ientry The task's entry.
+   * @param inow The current time in milliseconds.
+   */
+  void check(Entry &ientry, std::uint32_t inow);
+
+  /**
+   * Checks every registered task. Called by the watchdog task every period.
+   */
+  void checkAll();
+};
+} // namespace okapi
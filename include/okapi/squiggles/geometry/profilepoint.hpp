@@ -95,6 +95,68 @@ struct ProfilePoint {
   double curvature;
   double time;
 };
+
+/**
+ * A ProfilePoint whose wheel velocities are stored with a custom allocator,
+ * such as okapi::ArenaAllocator, so that profiles can be built and copied
+ * without touching the heap.
+ */
+template <class Allocator> struct BasicProfilePoint {
+  using allocator_type = Allocator;
+
+  /**
+   * Defines an empty state along a motion profiled path.
+   *
+   * @param ialloc The allocator for the wheel velocities.
+   */
+  explicit BasicProfilePoint(const Allocator& ialloc)
+    : wheel_velocities(ialloc) {}
+
+  /**
+   * Copies a ProfilePoint.
+   *
+   * @param ipoint The state to copy.
+   * @param ialloc The allocator for the wheel velocities.
+   */
+  BasicProfilePoint(const ProfilePoint& ipoint, const Allocator& ialloc)
+    : vector(ipoint.vector),
+      wheel_velocities(ipoint.wheel_velocities.begin(),
+                       ipoint.wheel_velocities.end(),
+                       ialloc),
+      curvature(ipoint.curvature),
+      time(ipoint.time) {}
+
+  /**
+   * Copies this state into a heap-allocated ProfilePoint.
+   *
+   * @return The ProfilePoint.
+   */
+  ProfilePoint to_profile_point() const {
+    return ProfilePoint(
+      vector,
+      std::vector<double>(wheel_velocities.begin(), wheel_velocities.end()),
+      curvature,
+      time);
+  }
+
+  bool operator==(const BasicProfilePoint& other) const {
+    if (wheel_velocities.size() != other.wheel_velocities.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < wheel_velocities.size(); ++i) {
+      if (!nearly_equal(wheel_velocities[i], other.wheel_velocities[i])) {
+        return false;
+      }
+    }
+    return vector == other.vector && nearly_equal(curvature, other.curvature) &&
+           nearly_equal(time, other.time);
+  }
+
+  ControlVector vector;
+  std::vector<double, Allocator> wheel_velocities;
+  double curvature = 0;
+  double time = 0;
+};
 } // namespace squiggles
 
 #endif
\ No newline at end of file
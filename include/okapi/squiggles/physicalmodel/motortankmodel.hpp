@@ -0,0 +1,278 @@
+/**
+ * Copyright 2020 Jonathan Bayless
+ *
+ * Use of this source code is governed by an MIT-style license that can be found
+ * in the LICENSE file or at https://opensource.org/licenses/MIT.
+ */
+#ifndef _PHYSICAL_MODEL_MOTOR_TANK_MODEL_HPP_
+#define _PHYSICAL_MODEL_MOTOR_TANK_MODEL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "physicalmodel/physicalmodel.hpp"
+
+namespace squiggles {
+/**
+ * The torque/speed characteristics of a single DC motor measured at the
+ * output shaft of its gearbox (i.e. after the cartridge for a V5 motor).
+ */
+struct MotorCurve {
+  /**
+   * Defines a linear DC motor torque/speed curve.
+   *
+   * @param ifree_speed The no-load speed of the motor at the nominal voltage in
+   *                    radians per second.
+   * @param istall_torque The stall torque of the motor at the nominal voltage
+   *                      in newton meters.
+   * @param inominal_voltage The voltage at which the free speed and stall
+   *                         torque were measured in volts.
+   */
+  MotorCurve(double ifree_speed,
+             double istall_torque,
+             double inominal_voltage = 12.0)
+    : free_speed(ifree_speed),
+      stall_torque(istall_torque),
+      nominal_voltage(inominal_voltage) {}
+
+  /**
+   * V5 Smart Motor with the red (36:1, 100 rpm) cartridge.
+   */
+  static MotorCurve v5_red() {
+    return MotorCurve(100.0 * 2 * M_PI / 60.0, 2.1);
+  }
+
+  /**
+   * V5 Smart Motor with the green (18:1, 200 rpm) cartridge.
+   */
+  static MotorCurve v5_green() {
+    return MotorCurve(200.0 * 2 * M_PI / 60.0, 1.05);
+  }
+
+  /**
+   * V5 Smart Motor with the blue (6:1, 600 rpm) cartridge.
+   */
+  static MotorCurve v5_blue() {
+    return MotorCurve(600.0 * 2 * M_PI / 60.0, 0.35);
+  }
+
+  std::string to_string() const {
+    return "MotorCurve: {free_speed: " + std::to_string(free_speed) +
+           ", stall_torque: " + std::to_string(stall_torque) +
+           ", nominal_voltage: " + std::to_string(nominal_voltage) + "}";
+  }
+
+  double free_speed;
+  double stall_torque;
+  double nominal_voltage;
+};
+
+class MotorTankModel : public PhysicalModel {
+  public:
+  /**
+   * Defines a model of a tank drive whose velocity and acceleration limits are
+   * computed at every state from the torque/speed curve of its drive motors
+   * instead of from a single set of worst-case constraints.
+   *
+   * @param itrack_width The distance between the the wheels on each side of the
+   *                     robot in meters.
+   * @param iwheel_radius The radius of the drive wheels in meters.
+   * @param imotor The torque/speed curve of one drive motor.
+   * @param imotors_per_side The number of motors driving each side.
+   * @param igear_ratio The external gear ratio from the motor output shaft to
+   *                    the wheel (motor turns per wheel turn).
+   * @param imass The mass of the robot in kilograms.
+   * @param imoment_of_inertia The moment of inertia of the robot about its
+   *                           center of rotation in kilogram square meters.
+   * @param ilinear_constraints The absolute maximum values for the robot's
+   *                            movement. These are still respected, but are
+   *                            normally looser than what the motors allow.
+   * @param ibattery_voltage The voltage available to the motors in volts.
+   * @param ifriction_coeff The coefficient of friction between the wheels and
+   *                        the field, used to cap the force each side can
+   *                        apply before slipping.
+   * @param imargin The fraction of the modeled motor capability that profiles
+   *                may use, leaving headroom for the feedback controller.
+   */
+  MotorTankModel(double itrack_width,
+                 double iwheel_radius,
+                 MotorCurve imotor,
+                 int imotors_per_side,
+                 double igear_ratio,
+                 double imass,
+                 double imoment_of_inertia,
+                 Constraints ilinear_constraints,
+                 double ibattery_voltage = 12.0,
+                 double ifriction_coeff = 1.0,
+                 double imargin = 0.9)
+    : track_width(itrack_width),
+      wheel_radius(iwheel_radius),
+      motor(imotor),
+      motors_per_side(imotors_per_side),
+      gear_ratio(igear_ratio),
+      mass(imass),
+      moment_of_inertia(imoment_of_inertia),
+      linear_constraints(ilinear_constraints),
+      battery_voltage(ibattery_voltage),
+      friction_coeff(ifriction_coeff),
+      margin(imargin) {}
+
+  Constraints
+  constraints(const Pose pose, double curvature, double vel) override {
+    auto [min_accel, max_accel] = accel_constraint(pose, curvature, vel);
+    return Constraints(vel_constraint(pose, curvature, vel),
+                       max_accel,
+                       linear_constraints.max_jerk,
+                       linear_constraints.max_curvature,
+                       min_accel);
+  }
+
+  std::vector<double> linear_to_wheel_vels(double lin_vel,
+                                           double curvature) override {
+    auto wheel_vels = wheel_vels_for(lin_vel, curvature);
+    return std::vector<double>(wheel_vels.begin(), wheel_vels.end());
+  }
+
+  /**
+   * Updates the voltage available to the motors, e.g. from
+   * pros::battery::get_voltage(), so that paths generated afterwards reflect
+   * the current state of charge.
+   *
+   * @param ibattery_voltage The voltage available to the motors in volts.
+   */
+  void set_battery_voltage(double ibattery_voltage) {
+    battery_voltage = ibattery_voltage;
+  }
+
+  std::string to_string() const override {
+    return "MotorTankModel {track_width: " + std::to_string(track_width) +
+           ", wheel_radius: " + std::to_string(wheel_radius) + ", " +
+           motor.to_string() +
+           ", motors_per_side: " + std::to_string(motors_per_side) +
+           ", gear_ratio: " + std::to_string(gear_ratio) +
+           ", mass: " + std::to_string(mass) +
+           ", moment_of_inertia: " + std::to_string(moment_of_inertia) +
+           ", battery_voltage: " + std::to_string(battery_voltage) +
+           ", friction_coeff: " + std::to_string(friction_coeff) +
+           ", margin: " + std::to_string(margin) + ", " +
+           linear_constraints.to_string() + "}";
+  }
+
+  private:
+  /**
+   * The fraction of the motor's nominal output that the battery can supply.
+   * V5 motors regulate to their nominal voltage, so a fuller battery does not
+   * make them faster.
+   */
+  double voltage_scale() const {
+    return std::clamp(battery_voltage / motor.nominal_voltage, 0.0, 1.0);
+  }
+
+  /**
+   * The linear speed of a wheel when its motors are unloaded in meters per
+   * second.
+   */
+  double wheel_free_speed() const {
+    return motor.free_speed * voltage_scale() / gear_ratio * wheel_radius;
+  }
+
+  /**
+   * The range of force one side of the drive can apply to the robot while the
+   * side's wheels are moving at the given linear speed.
+   *
+   * @param wheel_vel The linear speed of the side's wheels in meters per
+   *                  second.
+   *
+   * @return The minimum (most negative) and maximum force in newtons.
+   */
+  std::tuple<double, double> side_force_limits(double wheel_vel) const {
+    const double free = wheel_free_speed();
+    const double stall_force =
+      motors_per_side * motor.stall_torque * voltage_scale() * gear_ratio /
+      wheel_radius;
+
+    // Linear torque/speed curve, clamped to the stall (current limited) value
+    // when the motor is back-driven.
+    const double speed_ratio = free > 0 ? wheel_vel / free : 0;
+    double max_force = std::min(stall_force, stall_force * (1 - speed_ratio));
+    double min_force = std::max(-stall_force, -stall_force * (1 + speed_ratio));
+
+    const double traction_force = friction_coeff * mass * K_GRAVITY / 2;
+    max_force = std::min(max_force, traction_force);
+    min_force = std::max(min_force, -traction_force);
+
+    return std::make_tuple(margin * min_force, margin * max_force);
+  }
+
+  double vel_constraint([[maybe_unused]] const Pose pose,
+                        double curvature,
+                        [[maybe_unused]] double vel) const {
+    const double max_wheel_vel =
+      std::min(margin * wheel_free_speed(), linear_constraints.max_vel);
+    return max_wheel_vel / (1 + std::abs(curvature) * track_width / 2);
+  }
+
+  std::tuple<double, double> accel_constraint([[maybe_unused]] const Pose pose,
+                                              double curvature,
+                                              double vel) const {
+    // For a state of constant curvature k the robot's angular acceleration is
+    // k * a, so the force each side must supply for a linear acceleration a is
+    // a * (m / 2 -/+ I * k / w).
+    const double half_turn = moment_of_inertia * curvature / track_width;
+    const double left_coeff = mass / 2 - half_turn;
+    const double right_coeff = mass / 2 + half_turn;
+
+    auto wheel_vels = wheel_vels_for(vel, curvature);
+
+    double min_accel = linear_constraints.min_accel;
+    double max_accel = linear_constraints.max_accel;
+    const double coeffs[2] = {left_coeff, right_coeff};
+    for (std::size_t i = 0; i < 2; ++i) {
+      auto [min_force, max_force] = side_force_limits(wheel_vels[i]);
+      if (std::abs(coeffs[i]) < K_EPSILON) {
+        continue;
+      }
+      double lo = min_force / coeffs[i];
+      double hi = max_force / coeffs[i];
+      if (coeffs[i] < 0) {
+        std::swap(lo, hi);
+      }
+      min_accel = std::max(min_accel, lo);
+      max_accel = std::min(max_accel, hi);
+    }
+
+    // The motors cannot hold this state, so keep the range well formed.
+    min_accel = std::min(min_accel, max_accel);
+
+    return std::make_tuple(min_accel, max_accel);
+  }
+
+  std::array<double, 2> wheel_vels_for(double lin_vel,
+                                       double curvature) const {
+    return {lin_vel - lin_vel * curvature * track_width / 2,
+            lin_vel + lin_vel * curvature * track_width / 2};
+  }
+
+  static constexpr double K_GRAVITY = 9.80665;
+  static constexpr double K_EPSILON = 1e-9;
+
+  double track_width;
+  double wheel_radius;
+  MotorCurve motor;
+  int motors_per_side;
+  double gear_ratio;
+  double mass;
+  double moment_of_inertia;
+  Constraints linear_constraints;
+  double battery_voltage;
+  double friction_coeff;
+  double margin;
+};
+} // namespace squiggles
+
+#endif
@@ -11,6 +11,7 @@
 #include "geometry/pose.hpp"
 #include "geometry/profilepoint.hpp"
 
+#include "physicalmodel/motortankmodel.hpp"
 #include "physicalmodel/passthroughmodel.hpp"
 #include "physicalmodel/physicalmodel.hpp"
 #include "physicalmodel/tankmodel.hpp"
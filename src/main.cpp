@@ -1,5 +1,9 @@
 #include "main.h"
+#include "okapi/api/util/fixedString.hpp"
+#include "okapi/api/util/mailbox.hpp"
+#include "okapi/impl/util/taskWatchdog.hpp"
 #include <cmath>
+#include <vector>
 
 enum SET_SPEEDS{ZERO = 0, QUARTER = 127/4, HALF = 127/2, THREE_QUARTERS = (int)(0.75 * 127), MAX = 127}; //25%, 50%, 75%, 100%
 enum ARM_DIRECTIONS{CLOSE = 0, OPEN = 1};
@@ -7,7 +11,20 @@ pros::Motor intake1_arm(9);
 pros::Motor intake2_arm(10);
 pros::Motor indexer; //Not added to bot yet
 double motor_pos_error = 50;
-double intake1_min, intake1_max, intake2_min, intake2_max;
+
+/*
+* Arm position limits recorded by calibrate_arms() and read by the other tasks
+*/
+struct ArmLimits {
+	double intake1_min, intake1_max, intake2_min, intake2_max;
+};
+okapi::Mailbox<ArmLimits> arm_limits;
+
+/*
+* Watches the opcontrol loop and stops its motors if it wedges
+*/
+std::unique_ptr<okapi::TaskWatchdog> watchdog;
+std::size_t opcontrol_heartbeat = okapi::TaskWatchdog::maxTasks;
 
 /*
 * Determine if motor position is in range
@@ -20,6 +37,7 @@ bool in_range(double pos, double target) {
 * Eases the arm motors towards their target positions
 */
 void ease_arm_movement(bool direction) {
+	const ArmLimits limits = arm_limits.read();
 
 	//True is towards max, false is towards min (Open/Close)
 	if (direction) {
@@ -28,7 +46,7 @@ void ease_arm_movement(bool direction) {
 		intake2_arm.move(-SET_SPEEDS(QUARTER));
 
 		//Move until position reached or timout
-		while (!in_range(intake1_arm.get_position(), intake1_max) && !in_range(intake2_arm.get_position(), intake2_max) && pros::c::millis() - start_time < 2000) {
+		while (!in_range(intake1_arm.get_position(), limits.intake1_max) && !in_range(intake2_arm.get_position(), limits.intake2_max) && pros::c::millis() - start_time < 2000) {
 			double move_speed;
 			double avg_offset = (std::abs(intake1_arm.get_position()) + std::abs(intake2_arm.get_position())) / 2;
 
@@ -48,7 +66,7 @@ void ease_arm_movement(bool direction) {
 		intake2_arm.move(SET_SPEEDS(MAX));
 
 		//Move until position reached or timout
-		while (!in_range(intake1_arm.get_position(), intake1_min) && !in_range(intake2_arm.get_position(), intake2_min) && pros::c::millis() - start_time < 2500) {
+		while (!in_range(intake1_arm.get_position(), limits.intake1_min) && !in_range(intake2_arm.get_position(), limits.intake2_min) && pros::c::millis() - start_time < 2500) {
 			double move_speed;
 			double avg_offset = (std::abs(intake1_arm.get_position()) + std::abs(intake2_arm.get_position())) / 2;
 
@@ -79,9 +97,11 @@ void ease_arm_movement(bool direction) {
 * Calibrates the min and max positions for the arms
 */
 void calibrate_arms() {
+	ArmLimits limits;
+
 	//Record start position
-	intake1_min = intake1_arm.get_position();
-	intake2_min = intake2_arm.get_position();
+	limits.intake1_min = intake1_arm.get_position();
+	limits.intake2_min = intake2_arm.get_position();
 
 	//Open (lower) the arms
 	intake1_arm.move(-SET_SPEEDS(QUARTER));
@@ -90,14 +110,17 @@ void calibrate_arms() {
 	pros::delay(1500);
 	
 	//Record end position
-	intake1_max = intake1_arm.get_position();
-	intake2_max = intake2_arm.get_position();
+	limits.intake1_max = intake1_arm.get_position();
+	limits.intake2_max = intake2_arm.get_position();
+	arm_limits.publish(limits);
 	
 	//Print min and max values 
-	auto values1 = "Min/max: " + std::to_string(intake1_min) + " " + std::to_string(intake1_max);
-	auto values2 = std::to_string(intake2_min) + " " + std::to_string(intake2_max);
-	pros::lcd::set_text(1, values1);
-	pros::lcd::set_text(2, values2);
+	okapi::FixedString<48> values1("Min/max: ");
+	values1.append(limits.intake1_min).append(' ').append(limits.intake1_max);
+	okapi::FixedString<48> values2;
+	values2.append(limits.intake2_min).append(' ').append(limits.intake2_max);
+	pros::c::lcd_set_text(1, values1.c_str());
+	pros::c::lcd_set_text(2, values2.c_str());
 	
 	//Stop trying to open (to avoid burnout)
 	intake1_arm.move(SET_SPEEDS(ZERO));
@@ -156,6 +179,9 @@ void initialize() {
 	pros::lcd::set_text(1, "Chaos Control!");
 	pros::lcd::register_btn1_cb(on_center_button);
 
+	watchdog = std::make_unique<okapi::TaskWatchdog>();
+	watchdog->start();
+
 	calibrate_arms();
 }
 
@@ -164,7 +190,10 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+	//The opcontrol task was stopped, not wedged
+	watchdog->disable(opcontrol_heartbeat);
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -190,6 +219,7 @@ void competition_initialize() {}
  * from where it left off.
  */
 void autonomous() { 
+	watchdog->disable(opcontrol_heartbeat);
 /*Temp cords for 
 new_gyro_p_turn(47.4,100.0);
 improved_pid_move(86.3,47.4,100.0);
@@ -318,6 +348,18 @@ void opcontrol() {
 	front_right_mtr.set_reversed(true);
 	back_right_mtr.set_reversed(true);
 
+	//Brake everything if the loop below stops checking in. The motors are copied
+	// because the safe state runs in the watchdog task. The task isn't suspended,
+	// so a stall only stops the robot until the loop checks in again.
+	std::vector<pros::Motor> watched_motors {front_left_mtr, back_left_mtr, front_right_mtr, back_right_mtr,
+		shooter1, shooter2, shooter3, roller, intake1_arm, intake2_arm};
+	std::vector<pros::motor_brake_mode_e_t> brake_modes;
+	for (const auto &motor : watched_motors) {
+		brake_modes.push_back(motor.get_brake_mode());
+	}
+	opcontrol_heartbeat = watchdog->registerTask("opcontrol", 200 * okapi::millisecond,
+		okapi::TaskWatchdog::stopMotors(watched_motors, pros::E_MOTOR_BRAKE_BRAKE), false);
+
 	/*
 	*                **Controls**
 	* -------------------------------------------
@@ -341,6 +383,15 @@ void opcontrol() {
 	* 
 	*/
 	while (true) {
+		//Recovered from a stall, so put back the brake modes the safe state replaced
+		const bool recovered = watchdog->isFaulted(opcontrol_heartbeat);
+		if (recovered) {
+			for (std::size_t i = 0; i < watched_motors.size(); i++) {
+				watched_motors[i].set_brake_mode(brake_modes[i]);
+			}
+		}
+		watchdog->checkIn(opcontrol_heartbeat);
+
 		//Twin stick movement	 
 		int left = master.get_analog(ANALOG_LEFT_Y);
 		int right = master.get_analog(ANALOG_RIGHT_Y);
@@ -372,7 +423,9 @@ void opcontrol() {
 
 		// Intake Roller
 		if (master.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_L2)) {
-			pros::lcd::print(5, "New button press: L2 %d", !toggle[1]);
+			okapi::FixedString<32> press("New button press: L2 ");
+			press.append(static_cast<int>(!toggle[1]));
+			pros::c::lcd_set_text(5, press.c_str());
 			toggle[1] = !toggle[1];
 
 			if (toggle[1]) {
@@ -382,6 +435,29 @@ void opcontrol() {
 
 		// Intake Arms
 		static int dir = 0; //1=Open, -1=Close
+
+		//The safe state stopped everything, but the mechanisms below are only
+		// commanded on button presses, so command whatever is toggled on again
+		if (recovered) {
+			if (toggle[0]) {
+				shooter1.move(SET_SPEEDS(MAX));
+				shooter2.move(-SET_SPEEDS(MAX));
+				shooter3.move(-SET_SPEEDS(MAX));
+			}
+
+			if (toggle[1]) {
+				roller = speeds[1];
+			}
+
+			//The auto shutoff below stops the arms again if they're already in range
+			if (dir == 1) {
+				intake1_arm.move(SET_SPEEDS(MAX));
+				intake2_arm.move(-SET_SPEEDS(MAX));
+			} else if (dir == -1) {
+				intake1_arm.move(-SET_SPEEDS(MAX));
+				intake2_arm.move(SET_SPEEDS(MAX));
+			}
+		}
 		
 		//Going Down
 		if (master.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_X)){ 
@@ -401,18 +477,24 @@ void opcontrol() {
 
 		double intake1_pos = intake1_arm.get_position();
 		double intake2_pos = intake2_arm.get_position();
+		const ArmLimits limits = arm_limits.read();
 
 		//Auto shutoff for the arms once they're in range
-		if (dir == 1 && in_range(intake1_pos, intake1_max) && in_range(intake2_pos, intake2_max)) {
+		if (dir == 1 && in_range(intake1_pos, limits.intake1_max) && in_range(intake2_pos, limits.intake2_max)) {
 			intake1_arm.move(SET_SPEEDS(ZERO));
 			intake2_arm.move(SET_SPEEDS(ZERO));
-		} else if (dir == -1 && in_range(intake1_pos, intake1_min) && in_range(intake2_pos, intake2_min)) {
+		} else if (dir == -1 && in_range(intake1_pos, limits.intake1_min) && in_range(intake2_pos, limits.intake2_min)) {
 			intake1_arm.move(SET_SPEEDS(ZERO));
 			intake2_arm.move(SET_SPEEDS(ZERO));
 		}
 
-		pros::lcd::print(5, "Intake Arm 1 Pos: %f", intake1_arm.get_position());
-		pros::lcd::print(6, "Intake Arm 2 Pos: %f", intake2_arm.get_position());
+		//Formatted on the stack, since lcd::print formats into a heap buffer every call
+		okapi::FixedString<48> arm_pos("Intake Arm 1 Pos: ");
+		arm_pos.append(intake1_arm.get_position());
+		pros::c::lcd_set_text(5, arm_pos.c_str());
+		arm_pos.clear();
+		arm_pos.append("Intake Arm 2 Pos: ").append(intake2_arm.get_position());
+		pros::c::lcd_set_text(6, arm_pos.c_str());
 
 		//Set Drive Train motor speeds
 		front_left_mtr = left;
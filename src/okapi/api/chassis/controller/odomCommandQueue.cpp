@@ -0,0 +1,245 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/chassis/controller/odomCommandQueue.hpp"
+#include "okapi/api/odometry/odomMath.hpp"
+#include <cmath>
+#include <mutex>
+
+namespace okapi {
+OdomCommandQueue::OdomCommandQueue(const TimeUtil &itimeUtil,
+                                   std::shared_ptr<OdomChassisController> icontroller,
+                                   std::unique_ptr<IterativePosPIDController> idistanceController,
+                                   std::unique_ptr<IterativePosPIDController> iangleController,
+                                   std::unique_ptr<IterativePosPIDController> iturnController,
+                                   const QLength &iexitRadius,
+                                   const QAngle &iexitAngle,
+                                   const QLength &isteerRadius,
+                                   const StateMode &imode,
+                                   std::shared_ptr<Logger> ilogger)
+  : logger(std::move(ilogger)),
+    timeUtil(itimeUtil),
+    controller(std::move(icontroller)),
+    distancePid(std::move(idistanceController)),
+    anglePid(std::move(iangleController)),
+    turnPid(std::move(iturnController)),
+    exitRadius(iexitRadius),
+    exitAngle(iexitAngle.abs()),
+    steerRadius(isteerRadius),
+    mode(imode) {
+}
+
+OdomCommandQueue::~OdomCommandQueue() {
+  dtorCalled.store(true, std::memory_order_release);
+  delete task;
+}
+
+std::uint32_t OdomCommandQueue::driveToPoint(const Point &ipoint, const bool ibackwards) {
+  return driveToPoint(ipoint, ibackwards, exitRadius);
+}
+
+std::uint32_t OdomCommandQueue::driveToPoint(const Point &ipoint,
+                                             const bool ibackwards,
+                                             const QLength &iexitRadius) {
+  return enqueue({0, CommandType::drive, ipoint, 0_deg, ibackwards, iexitRadius});
+}
+
+std::uint32_t OdomCommandQueue::turnToPoint(const Point &ipoint) {
+  return enqueue({0, CommandType::turnToPoint, ipoint, 0_deg, false, 0_m});
+}
+
+std::uint32_t OdomCommandQueue::turnToAngle(const QAngle &iangle) {
+  return enqueue({0, CommandType::turnToAngle, {}, iangle, false, 0_m});
+}
+
+std::uint32_t OdomCommandQueue::enqueue(Command icommand) {
+  std::lock_guard<CrossplatformMutex> lock(queueMutex);
+  icommand.id = nextId++;
+  commands.push_back(icommand);
+  idle.store(false, std::memory_order_release);
+  return icommand.id;
+}
+
+void OdomCommandQueue::waitUntilDone(const std::uint32_t iid) {
+  {
+    std::lock_guard<CrossplatformMutex> lock(queueMutex);
+    if (iid >= nextId) {
+      LOG_WARN("OdomCommandQueue: Movement " + std::to_string(iid) + " was never queued.");
+      return;
+    }
+  }
+
+  auto rate = timeUtil.getRate();
+  while (doneId.load(std::memory_order_acquire) < iid && !dtorCalled.load()) {
+    rate->delayUntil(10_ms);
+  }
+}
+
+void OdomCommandQueue::waitUntilSettled() {
+  auto rate = timeUtil.getRate();
+  while (!isSettled() && !dtorCalled.load()) {
+    rate->delayUntil(10_ms);
+  }
+}
+
+bool OdomCommandQueue::isSettled() const {
+  return idle.load(std::memory_order_acquire);
+}
+
+std::size_t OdomCommandQueue::size() {
+  std::lock_guard<CrossplatformMutex> lock(queueMutex);
+  return commands.size();
+}
+
+void OdomCommandQueue::stop() {
+  LOG_INFO_S("OdomCommandQueue: Stopping");
+
+  // The loop holds the lock while it steps a command, so the chassis can't be driven again after
+  // this.
+  std::lock_guard<CrossplatformMutex> lock(queueMutex);
+  commands.clear();
+  doneId.store(nextId - 1, std::memory_order_release);
+  controller->model().stop();
+  idle.store(true, std::memory_order_release);
+}
+
+void OdomCommandQueue::startThread() {
+  if (!task) {
+    task = new CrossplatformThread(trampoline, this, "OdomCommandQueue");
+  }
+}
+
+bool OdomCommandQueue::stepCommand(const Command &icommand,
+                                   const bool ilast,
+                                   const bool ireseed) {
+  const auto state = controller->getOdometry()->getState(StateMode::FRAME_TRANSFORMATION);
+
+  if (icommand.type == CommandType::drive) {
+    auto [distance, angle] =
+      OdomMath::computeDistanceAndAngleToPoint(icommand.point.inFT(mode), state);
+
+    double direction = 1;
+    if (icommand.backwards) {
+      angle = OdomMath::constrainAngle180(angle + 180_deg);
+      direction = -1;
+    }
+
+    // Project the remaining distance onto the heading so the robot slows while it is still turning
+    // towards the target.
+    const double projected = distance.convert(meter) * std::cos(angle.convert(radian));
+
+    // The distance and angle to the target jump at a hand-over. Shift the targets by the same
+    // amount so the readings carry on from the last ones and the derivative doesn't kick, while
+    // the integral and output carry over.
+    if (ireseed) {
+      distanceOffset = distancePid->getProcessValue() + projected;
+      angleOffset = anglePid->getProcessValue() + angle.convert(degree);
+      distancePid->setTarget(distanceOffset);
+      anglePid->setTarget(angleOffset);
+    }
+
+    const double forward = direction * distancePid->step(distanceOffset - projected);
+
+    // Near the final target the heading to it swings wildly, so only hold the forward controller.
+    double yaw = 0;
+    if (!ilast || distance > steerRadius) {
+      yaw = anglePid->step(angleOffset - angle.convert(degree));
+    }
+
+    controller->model().driveVector(forward, yaw);
+
+    if (!ilast) {
+      return distance < icommand.exitRadius;
+    }
+
+    return distancePid->isSettled();
+  }
+
+  QAngle angle;
+  if (icommand.type == CommandType::turnToPoint) {
+    angle = OdomMath::computeAngleToPoint(icommand.point.inFT(mode), state);
+  } else {
+    angle = OdomMath::constrainAngle180(icommand.angle - state.theta);
+  }
+
+  controller->model().driveVector(0, turnPid->step(-angle.convert(degree)));
+
+  if (!ilast) {
+    return angle.abs() < exitAngle;
+  }
+
+  return turnPid->isSettled();
+}
+
+void OdomCommandQueue::trampoline(void *context) {
+  if (context) {
+    static_cast<OdomCommandQueue *>(context)->loop();
+  }
+}
+
+void OdomCommandQueue::loop() {
+  LOG_INFO_S("Started OdomCommandQueue task.");
+
+  auto rate = timeUtil.getRate();
+  std::uint32_t activeId = 0;
+  bool activeIsDrive = false;
+  bool chained = false;
+
+  while (!dtorCalled.load(std::memory_order_acquire)) {
+    {
+      std::lock_guard<CrossplatformMutex> lock(queueMutex);
+
+      if (commands.empty()) {
+        chained = false;
+      } else {
+        const Command command = commands.front();
+        const bool last = commands.size() == 1;
+        const bool isDrive = command.type == CommandType::drive;
+
+        bool reseedPids = false;
+        if (command.id != activeId) {
+          // Keep the controllers' state across blended drives so the output doesn't drop, but
+          // start fresh after an idle period or a change between driving and turning.
+          reseedPids = chained && isDrive && activeIsDrive;
+          if (!reseedPids) {
+            distancePid->reset();
+            anglePid->reset();
+            turnPid->reset();
+
+            distanceOffset = 0;
+            angleOffset = 0;
+            distancePid->setTarget(0);
+            anglePid->setTarget(0);
+            turnPid->setTarget(0);
+          }
+
+          LOG_INFO("OdomCommandQueue: Starting movement " + std::to_string(command.id) +
+                   " to {x: " + std::to_string(command.point.x.convert(meter)) +
+                   " m, y: " + std::to_string(command.point.y.convert(meter)) +
+                   " m, theta: " + std::to_string(command.angle.convert(degree)) + " deg}");
+
+          activeId = command.id;
+          activeIsDrive = isDrive;
+        }
+
+        if (stepCommand(command, last, reseedPids)) {
+          commands.pop_front();
+          doneId.store(command.id, std::memory_order_release);
+
+          chained = !commands.empty();
+          if (!chained) {
+            controller->model().stop();
+            idle.store(true, std::memory_order_release);
+          }
+        }
+      }
+    }
+
+    rate->delayUntil(10_ms);
+  }
+
+  LOG_INFO_S("Stopped OdomCommandQueue task.");
+}
+} // namespace okapi
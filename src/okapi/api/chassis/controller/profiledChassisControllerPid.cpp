@@ -0,0 +1,154 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/chassis/controller/profiledChassisControllerPid.hpp"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace okapi {
+ProfiledChassisControllerPID::ProfiledChassisControllerPID(
+  TimeUtil itimeUtil,
+  std::shared_ptr<ChassisModel> imodel,
+  std::unique_ptr<IterativePosPIDController> idistanceController,
+  std::unique_ptr<IterativePosPIDController> iturnController,
+  std::unique_ptr<IterativePosPIDController> iangleController,
+  const ChassisProfileLimits &idistanceLimits,
+  const ChassisProfileLimits &iturnLimits,
+  const ProfileMode imode,
+  const AbstractMotor::GearsetRatioPair &igearset,
+  const ChassisScales &iscales,
+  std::shared_ptr<Logger> ilogger)
+  : SteppedChassisControllerPID(itimeUtil,
+                                std::move(imodel),
+                                std::move(idistanceController),
+                                std::move(iturnController),
+                                std::move(iangleController),
+                                igearset,
+                                iscales,
+                                std::move(ilogger),
+                                "ProfiledChassisControllerPID"),
+    distanceLimits(idistanceLimits),
+    turnLimits(iturnLimits),
+    profileMode(imode),
+    timer(itimeUtil.getTimer()) {
+  if (distanceLimits.maxVel <= 0 || distanceLimits.maxAccel <= 0 || turnLimits.maxVel <= 0 ||
+      turnLimits.maxAccel <= 0) {
+    std::string msg = "ProfiledChassisControllerPID: The profile limits must be greater than zero.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+}
+
+ProfiledChassisControllerPID::~ProfiledChassisControllerPID() {
+  stopThread();
+}
+
+void ProfiledChassisControllerPID::moveDistanceAsync(const QLength itarget) {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  SteppedChassisControllerPID::moveDistanceAsync(itarget);
+  startProfile(*distancePid, distanceLimits, scales.straight * gearsetRatioPair.ratio);
+}
+
+void ProfiledChassisControllerPID::turnAngleAsync(const QAngle idegTarget) {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  SteppedChassisControllerPID::turnAngleAsync(idegTarget);
+  startProfile(*turnPid, turnLimits, scales.turn * gearsetRatioPair.ratio);
+}
+
+bool ProfiledChassisControllerPID::isSettled() {
+  return isProfileDone() && ChassisControllerPID::isSettled();
+}
+
+void ProfiledChassisControllerPID::waitUntilSettled() {
+  // The PIDs can look settled while they track the profile, so wait for it to finish first.
+  auto rate = timeUtil.getRate();
+  while (!isProfileDone() && mode != none) {
+    rate->delayUntil(threadSleepTime);
+  }
+
+  ChassisControllerPID::waitUntilSettled();
+}
+
+void ProfiledChassisControllerPID::setProfileMode(const ProfileMode imode) {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  profileMode = imode;
+}
+
+ProfiledChassisControllerPID::ProfileMode ProfiledChassisControllerPID::getProfileMode() const {
+  return profileMode;
+}
+
+void ProfiledChassisControllerPID::setDistanceLimits(const ChassisProfileLimits &ilimits) {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  distanceLimits = ilimits;
+}
+
+void ProfiledChassisControllerPID::setTurnLimits(const ChassisProfileLimits &ilimits) {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  turnLimits = ilimits;
+}
+
+void ProfiledChassisControllerPID::startProfile(IterativePosPIDController &ipid,
+                                                const ChassisProfileLimits &ilimits,
+                                                const double iscale) {
+  if (profileMode == ProfileMode::step) {
+    profileActive = false;
+    return;
+  }
+
+  // The base class already converted the target to encoder units and applied turn mirroring.
+  const double target = ipid.getTarget();
+  profile = MotionProfile(target,
+                          ilimits.maxVel * iscale,
+                          ilimits.maxAccel * iscale,
+                          profileMode == ProfileMode::sCurve ? MotionProfile::Shape::sCurve
+                                                             : MotionProfile::Shape::trapezoidal);
+  activeLimits = ilimits;
+  activeScale = iscale;
+  profileStart = timer->millis();
+  profileActive = true;
+
+  // The PID is stepped with the reading relative to the setpoint, so its target stays at zero
+  // while the profile runs and its error is still the distance to the final target at the end.
+  ipid.setTarget(0);
+
+  LOG_INFO("ProfiledChassisControllerPID: Profiled " + std::to_string(target) + " over " +
+           std::to_string(profile.getDuration().convert(second)) + " s");
+}
+
+bool ProfiledChassisControllerPID::isProfileDone() {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  return !profileActive || timer->millis() - profileStart >= profile.getDuration();
+}
+
+double ProfiledChassisControllerPID::stepProfile(IterativePosPIDController &ipid,
+                                                 const double ireading) {
+  if (!profileActive) {
+    return ipid.step(ireading);
+  }
+
+  const auto setpoint = profile.get(timer->millis() - profileStart);
+  const double feedforward = activeLimits.kV * setpoint.velocity / activeScale +
+                             activeLimits.kA * setpoint.acceleration / activeScale;
+
+  return std::clamp(ipid.step(ireading - setpoint.position) + feedforward,
+                    ipid.getMinOutput(),
+                    ipid.getMaxOutput());
+}
+
+void ProfiledChassisControllerPID::stepMovement() {
+  std::lock_guard<CrossplatformMutex> lock(profileMutex);
+  SteppedChassisControllerPID::stepMovement();
+}
+
+double ProfiledChassisControllerPID::stepDistancePid(const double idistanceElapsed) {
+  return stepProfile(*distancePid, idistanceElapsed);
+}
+
+double ProfiledChassisControllerPID::stepTurnPid(const double iangleChange) {
+  return stepProfile(*turnPid, iangleChange);
+}
+} // namespace okapi
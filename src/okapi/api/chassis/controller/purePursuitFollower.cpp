@@ -0,0 +1,343 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/chassis/controller/purePursuitFollower.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace okapi {
+PurePursuitPath PurePursuitPath::fromPoints(const std::vector<Point> &ipoints,
+                                            const QLength &ispacing,
+                                            const QSpeed &imaxVelocity,
+                                            const QAcceleration &imaxAcceleration,
+                                            const double iturnConstant,
+                                            const QSpeed &iminVelocity,
+                                            const StateMode &imode) {
+  const auto logger = Logger::getDefaultLogger();
+
+  if (ispacing <= 0_m) {
+    std::string msg = "PurePursuitPath: The spacing must be greater than zero.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (imaxAcceleration <= 0_mps2) {
+    std::string msg = "PurePursuitPath: The max acceleration must be greater than zero.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  PurePursuitPath out;
+  if (ipoints.empty()) {
+    return out;
+  }
+
+  const double spacing = ispacing.convert(meter);
+  const Point first = ipoints.front().inFT(imode);
+  out.waypoints.push_back({first.x.convert(meter), first.y.convert(meter)});
+
+  for (std::size_t i = 1; i < ipoints.size(); i++) {
+    const Point point = ipoints[i].inFT(imode);
+    const double x = point.x.convert(meter);
+    const double y = point.y.convert(meter);
+    const double startX = out.waypoints.back().x;
+    const double startY = out.waypoints.back().y;
+    const double length = std::hypot(x - startX, y - startY);
+
+    if (length <= 0) {
+      continue;
+    }
+
+    const auto steps = static_cast<std::size_t>(std::ceil(length / spacing));
+    for (std::size_t j = 1; j <= steps; j++) {
+      const double t = static_cast<double>(j) / steps;
+      out.waypoints.push_back({startX + (x - startX) * t, startY + (y - startY) * t});
+    }
+  }
+
+  out.computeGeometry();
+
+  const double maxVelocity = imaxVelocity.convert(mps);
+  const double minVelocity = std::min(iminVelocity.convert(mps), maxVelocity);
+  const double maxAcceleration = imaxAcceleration.convert(mps2);
+
+  for (auto &waypoint : out.waypoints) {
+    const double curvature = std::abs(waypoint.curvature);
+    waypoint.velocity =
+      curvature > 0 ? std::min(maxVelocity, iturnConstant / curvature) : maxVelocity;
+  }
+
+  // Accelerate from rest at the start and decelerate to rest at the end.
+  auto &wps = out.waypoints;
+  wps.front().velocity = std::min(wps.front().velocity, minVelocity);
+  for (std::size_t i = 1; i < wps.size(); i++) {
+    const double ds = wps[i].distance - wps[i - 1].distance;
+    const double reachable = std::sqrt(wps[i - 1].velocity * wps[i - 1].velocity +
+                                       2 * maxAcceleration * ds);
+    wps[i].velocity = std::min(wps[i].velocity, reachable);
+  }
+
+  wps.back().velocity = 0;
+  for (std::size_t i = wps.size() - 1; i > 0; i--) {
+    const double ds = wps[i].distance - wps[i - 1].distance;
+    const double stoppable =
+      std::sqrt(wps[i].velocity * wps[i].velocity + 2 * maxAcceleration * ds);
+    wps[i - 1].velocity = std::min(wps[i - 1].velocity, stoppable);
+  }
+
+  for (auto &waypoint : wps) {
+    waypoint.velocity = std::max(waypoint.velocity, minVelocity);
+  }
+
+  return out;
+}
+
+PurePursuitPath PurePursuitPath::fromProfile(const std::vector<squiggles::ProfilePoint> &iprofile,
+                                             const QSpeed &iminVelocity,
+                                             const StateMode &imode) {
+  PurePursuitPath out;
+  out.waypoints.reserve(iprofile.size());
+
+  const double minVelocity = iminVelocity.convert(mps);
+  for (const auto &point : iprofile) {
+    const Point pose = Point{point.vector.pose.x * meter, point.vector.pose.y * meter}.inFT(imode);
+
+    Waypoint waypoint;
+    waypoint.x = pose.x.convert(meter);
+    waypoint.y = pose.y.convert(meter);
+    waypoint.velocity = std::max(std::abs(point.vector.vel), minVelocity);
+    out.waypoints.push_back(waypoint);
+  }
+
+  out.computeGeometry();
+  return out;
+}
+
+const std::vector<PurePursuitPath::Waypoint> &PurePursuitPath::getWaypoints() const {
+  return waypoints;
+}
+
+QLength PurePursuitPath::getLength() const {
+  return waypoints.empty() ? 0_m : waypoints.back().distance * meter;
+}
+
+void PurePursuitPath::computeGeometry() {
+  for (std::size_t i = 1; i < waypoints.size(); i++) {
+    waypoints[i].distance =
+      waypoints[i - 1].distance +
+      std::hypot(waypoints[i].x - waypoints[i - 1].x, waypoints[i].y - waypoints[i - 1].y);
+  }
+
+  // The curvature of the circle through each waypoint and its neighbours. In the frame
+  // transformation state mode y points right, so a positive cross product curves to the right.
+  for (std::size_t i = 1; i + 1 < waypoints.size(); i++) {
+    const auto &a = waypoints[i - 1];
+    const auto &b = waypoints[i];
+    const auto &c = waypoints[i + 1];
+    const double cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+    const double denominator = std::hypot(b.x - a.x, b.y - a.y) * std::hypot(c.x - b.x, c.y - b.y) *
+                               std::hypot(c.x - a.x, c.y - a.y);
+    waypoints[i].curvature = denominator > 0 ? 2 * cross / denominator : 0;
+  }
+}
+
+PurePursuitFollower::PurePursuitFollower(const TimeUtil &itimeUtil,
+                                         std::shared_ptr<OdomChassisController> icontroller,
+                                         const QTime &ilookaheadTime,
+                                         const QLength &iminLookahead,
+                                         const QLength &imaxLookahead,
+                                         const QLength &igoalTolerance,
+                                         std::shared_ptr<Logger> ilogger)
+  : logger(std::move(ilogger)),
+    timeUtil(itimeUtil),
+    controller(std::move(icontroller)),
+    lookaheadTime(ilookaheadTime.convert(second)),
+    minLookahead(iminLookahead.convert(meter)),
+    maxLookahead(imaxLookahead.convert(meter)),
+    goalTolerance(igoalTolerance.convert(meter)) {
+  if (minLookahead <= 0 || maxLookahead < minLookahead) {
+    std::string msg = "PurePursuitFollower: The lookahead distances must be greater than zero and "
+                      "the max lookahead must be at least the min lookahead.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+}
+
+void PurePursuitFollower::setPath(PurePursuitPath ipath, const bool ibackwards) {
+  path = std::move(ipath);
+  backwards = ibackwards;
+  closestIndex = 0;
+  lookaheadIndex = 0;
+  lookaheadFraction = 0;
+
+  const auto &waypoints = path.getWaypoints();
+  if (waypoints.empty()) {
+    LOG_WARN_S("PurePursuitFollower: The path is empty.");
+    done.store(true, std::memory_order_release);
+    return;
+  }
+
+  lookaheadX = waypoints.front().x;
+  lookaheadY = waypoints.front().y;
+
+  LOG_INFO("PurePursuitFollower: Following a path of " + std::to_string(waypoints.size()) +
+           " waypoints and " + std::to_string(path.getLength().convert(meter)) + " m");
+
+  done.store(false, std::memory_order_release);
+}
+
+bool PurePursuitFollower::step() {
+  if (done.load(std::memory_order_acquire)) {
+    return true;
+  }
+
+  const auto &waypoints = path.getWaypoints();
+  const auto state = controller->getOdometry()->getState(StateMode::FRAME_TRANSFORMATION);
+  const double x = state.x.convert(meter);
+  const double y = state.y.convert(meter);
+  double theta = state.theta.convert(radian);
+  if (backwards) {
+    theta += 1_pi;
+  }
+
+  auto distanceSquared = [&](const std::size_t i) {
+    const double dx = waypoints[i].x - x;
+    const double dy = waypoints[i].y - y;
+    return dx * dx + dy * dy;
+  };
+
+  while (closestIndex + 1 < waypoints.size() &&
+         distanceSquared(closestIndex + 1) <= distanceSquared(closestIndex)) {
+    closestIndex++;
+  }
+
+  const auto &end = waypoints.back();
+  const double endDistance = std::hypot(end.x - x, end.y - y);
+
+  bool passedEnd = false;
+  if (closestIndex + 1 == waypoints.size() && waypoints.size() > 1) {
+    const auto &previous = waypoints[waypoints.size() - 2];
+    passedEnd = (x - end.x) * (end.x - previous.x) + (y - end.y) * (end.y - previous.y) > 0;
+  }
+
+  if (endDistance < goalTolerance || passedEnd) {
+    LOG_INFO_S("PurePursuitFollower: Done following the path");
+    stop();
+    return true;
+  }
+
+  const double velocity = waypoints[closestIndex].velocity;
+  const double lookahead = std::clamp(lookaheadTime * velocity, minLookahead, maxLookahead);
+
+  if (endDistance < lookahead) {
+    lookaheadX = end.x;
+    lookaheadY = end.y;
+  } else {
+    updateLookahead(x, y, lookahead);
+  }
+
+  // The curvature of the arc from the robot to the lookahead point. Positive curves to the right.
+  const double dx = lookaheadX - x;
+  const double dy = lookaheadY - y;
+  const double lateral = -std::sin(theta) * dx + std::cos(theta) * dy;
+  const double chord = dx * dx + dy * dy;
+  const double curvature = chord > 0 ? 2 * lateral / chord : 0;
+
+  const double halfTrack = controller->getChassisScales().wheelTrack.convert(meter) / 2;
+  double leftVelocity = velocity * (1 + curvature * halfTrack);
+  double rightVelocity = velocity * (1 - curvature * halfTrack);
+  if (backwards) {
+    // Driving backwards swaps the sides as well as the direction.
+    const double temp = leftVelocity;
+    leftVelocity = -rightVelocity;
+    rightVelocity = -temp;
+  }
+
+  const auto gearsetRatioPair = controller->getGearsetRatioPair();
+  const double maxWheelVelocity = controller->getMaxVelocity() / gearsetRatioPair.ratio *
+                                  controller->getChassisScales().wheelDiameter.convert(meter) *
+                                  1_pi / 60;
+  double left = leftVelocity / maxWheelVelocity;
+  double right = rightVelocity / maxWheelVelocity;
+
+  // Scale both sides together so the curvature is kept when one side saturates.
+  const double largest = std::max(std::abs(left), std::abs(right));
+  if (largest > 1) {
+    left /= largest;
+    right /= largest;
+  }
+
+  controller->model().left(left);
+  controller->model().right(right);
+  return false;
+}
+
+void PurePursuitFollower::followPath(PurePursuitPath ipath, const bool ibackwards) {
+  setPath(std::move(ipath), ibackwards);
+
+  auto rate = timeUtil.getRate();
+  while (!step()) {
+    rate->delayUntil(10_ms);
+  }
+}
+
+bool PurePursuitFollower::isSettled() const {
+  return done.load(std::memory_order_acquire);
+}
+
+void PurePursuitFollower::stop() {
+  done.store(true, std::memory_order_release);
+  controller->model().stop();
+}
+
+std::size_t PurePursuitFollower::getClosestIndex() const {
+  return closestIndex;
+}
+
+Point PurePursuitFollower::getLookaheadPoint() const {
+  return {lookaheadX * meter, lookaheadY * meter};
+}
+
+void PurePursuitFollower::updateLookahead(const double ix, const double iy, const double iradius) {
+  const auto &waypoints = path.getWaypoints();
+
+  // A crossing further along the path than this would mean skipping part of it.
+  const auto &closest = waypoints[closestIndex];
+  const double distanceLimit =
+    closest.distance + iradius + std::hypot(closest.x - ix, closest.y - iy);
+
+  for (std::size_t i = lookaheadIndex; i + 1 < waypoints.size(); i++) {
+    if (waypoints[i].distance > distanceLimit) {
+      break;
+    }
+
+    const double segmentX = waypoints[i + 1].x - waypoints[i].x;
+    const double segmentY = waypoints[i + 1].y - waypoints[i].y;
+    const double offsetX = waypoints[i].x - ix;
+    const double offsetY = waypoints[i].y - iy;
+
+    const double a = segmentX * segmentX + segmentY * segmentY;
+    const double b = 2 * (offsetX * segmentX + offsetY * segmentY);
+    const double c = offsetX * offsetX + offsetY * offsetY - iradius * iradius;
+    const double discriminant = b * b - 4 * a * c;
+    if (a <= 0 || discriminant < 0) {
+      continue;
+    }
+
+    // Prefer the crossing further along the segment, where the path leaves the circle.
+    const double root = std::sqrt(discriminant);
+    for (const double t : {(-b + root) / (2 * a), (-b - root) / (2 * a)}) {
+      if (t >= 0 && t <= 1 && (i > lookaheadIndex || t >= lookaheadFraction)) {
+        lookaheadIndex = i;
+        lookaheadFraction = t;
+        lookaheadX = waypoints[i].x + t * segmentX;
+        lookaheadY = waypoints[i].y + t * segmentY;
+        return;
+      }
+    }
+  }
+}
+} // namespace okapi
@@ -0,0 +1,134 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/chassis/controller/steppedChassisControllerPid.hpp"
+
+namespace okapi {
+SteppedChassisControllerPID::SteppedChassisControllerPID(
+  TimeUtil itimeUtil,
+  std::shared_ptr<ChassisModel> imodel,
+  std::unique_ptr<IterativePosPIDController> idistanceController,
+  std::unique_ptr<IterativePosPIDController> iturnController,
+  std::unique_ptr<IterativePosPIDController> iangleController,
+  const AbstractMotor::GearsetRatioPair &igearset,
+  const ChassisScales &iscales,
+  std::shared_ptr<Logger> ilogger,
+  std::string ithreadName)
+  : ChassisControllerPID(std::move(itimeUtil),
+                         std::move(imodel),
+                         std::move(idistanceController),
+                         std::move(iturnController),
+                         std::move(iangleController),
+                         igearset,
+                         iscales,
+                         std::move(ilogger)),
+    threadName(std::move(ithreadName)) {
+}
+
+SteppedChassisControllerPID::~SteppedChassisControllerPID() {
+  stopThread();
+}
+
+void SteppedChassisControllerPID::stopThread() {
+  dtorCalled.store(true, std::memory_order_release);
+
+  // Null it out so ChassisControllerPID's destructor doesn't delete it again.
+  delete task;
+  task = nullptr;
+}
+
+void SteppedChassisControllerPID::startThread() {
+  if (!task) {
+    task = new CrossplatformThread(steppedTrampoline, this, threadName.c_str());
+  }
+}
+
+void SteppedChassisControllerPID::stepMovement() {
+  if (mode != pastMode || newMovement.load(std::memory_order_acquire)) {
+    encStartVals = chassisModel->getSensorVals();
+    newMovement.store(false, std::memory_order_release);
+  }
+
+  double output = 0;
+  switch (mode) {
+  case distance: {
+    encVals = chassisModel->getSensorVals() - encStartVals;
+    const double distanceElapsed = static_cast<double>((encVals[0] + encVals[1])) / 2.0;
+    const double angleChange = static_cast<double>(encVals[0] - encVals[1]);
+
+    output = stepDistancePid(distanceElapsed);
+    anglePid->step(angleChange);
+
+    if (velocityMode) {
+      chassisModel->driveVector(output, anglePid->getOutput());
+    } else {
+      chassisModel->driveVectorVoltage(output, anglePid->getOutput());
+    }
+    break;
+  }
+
+  case angle: {
+    encVals = chassisModel->getSensorVals() - encStartVals;
+    const double angleChange = static_cast<double>(encVals[0] - encVals[1]);
+
+    output = stepTurnPid(angleChange);
+
+    if (velocityMode) {
+      chassisModel->driveVector(0, output);
+    } else {
+      chassisModel->driveVectorVoltage(0, output);
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+
+  pastMode = mode;
+}
+
+double SteppedChassisControllerPID::stepDistancePid(const double idistanceElapsed) {
+  return distancePid->step(idistanceElapsed);
+}
+
+double SteppedChassisControllerPID::stepTurnPid(const double iangleChange) {
+  return turnPid->step(iangleChange);
+}
+
+void SteppedChassisControllerPID::waitIdle(AbstractRate &irate) {
+  irate.delayUntil(threadSleepTime);
+}
+
+void SteppedChassisControllerPID::waitStep(AbstractRate &irate) {
+  irate.delayUntil(threadSleepTime);
+}
+
+void SteppedChassisControllerPID::steppedTrampoline(void *context) {
+  if (context) {
+    static_cast<SteppedChassisControllerPID *>(context)->steppedLoop();
+  }
+}
+
+void SteppedChassisControllerPID::steppedLoop() {
+  LOG_INFO("Started " + threadName + " task.");
+
+  encStartVals = chassisModel->getSensorVals();
+  auto rate = timeUtil.getRate();
+
+  while (!dtorCalled.load(std::memory_order_acquire)) {
+    if (mode == none || doneLooping.load(std::memory_order_acquire)) {
+      doneLoopingSeen.store(true, std::memory_order_release);
+      waitIdle(*rate);
+      continue;
+    }
+
+    stepMovement();
+    waitStep(*rate);
+  }
+
+  LOG_INFO("Stopped " + threadName + " task.");
+}
+} // namespace okapi
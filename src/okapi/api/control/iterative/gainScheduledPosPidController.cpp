@@ -0,0 +1,83 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/gainScheduledPosPidController.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace okapi {
+GainScheduledPosPIDController::GainScheduledPosPIDController(
+  std::vector<SchedulePoint> ischedule,
+  const std::shared_ptr<ControllerInput<double>> &ischeduleInput,
+  const TimeUtil &itimeUtil,
+  const bool ibumpless,
+  std::unique_ptr<Filter> iderivativeFilter,
+  std::shared_ptr<Logger> ilogger)
+  : IterativePosPIDController(ischedule.empty() ? Gains{} : ischedule.front().gains,
+                              itimeUtil,
+                              std::move(iderivativeFilter),
+                              std::move(ilogger)),
+    scheduleInput(ischeduleInput),
+    bumpless(ibumpless) {
+  setSchedule(std::move(ischedule));
+}
+
+void GainScheduledPosPIDController::setSchedule(std::vector<SchedulePoint> ischedule) {
+  if (ischedule.empty()) {
+    std::string msg("GainScheduledPosPIDController: The schedule must not be empty.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  std::sort(ischedule.begin(), ischedule.end(), [](const auto &a, const auto &b) {
+    return a.key < b.key;
+  });
+  schedule = std::move(ischedule);
+}
+
+IterativePosPIDController::Gains
+GainScheduledPosPIDController::getScheduledGains(const double ikey) const {
+  if (ikey <= schedule.front().key) {
+    return schedule.front().gains;
+  }
+
+  if (ikey >= schedule.back().key) {
+    return schedule.back().gains;
+  }
+
+  const auto upper = std::upper_bound(
+    schedule.begin(), schedule.end(), ikey, [](const double key, const SchedulePoint &point) {
+      return key < point.key;
+    });
+  const auto lower = upper - 1;
+
+  const double t = (ikey - lower->key) / (upper->key - lower->key);
+  const auto lerp = [t](const double a, const double b) { return a + t * (b - a); };
+  return {lerp(lower->gains.kP, upper->gains.kP),
+          lerp(lower->gains.kI, upper->gains.kI),
+          lerp(lower->gains.kD, upper->gains.kD),
+          lerp(lower->gains.kBias, upper->gains.kBias)};
+}
+
+double GainScheduledPosPIDController::step(const double inewReading) {
+  if (!isDisabled()) {
+    const double key = scheduleInput ? scheduleInput->controllerGet() : inewReading;
+    const Gains current = getGains();
+    const Gains next = getScheduledGains(key);
+
+    if (next != current) {
+      if (bumpless) {
+        // Keep kP * error + integral + kBias the same for the last error.
+        integral += (current.kP - next.kP) * error + (current.kBias - next.kBias);
+        integral = std::clamp(integral, integralMin, integralMax);
+      }
+
+      setGains(next);
+    }
+  }
+
+  return IterativePosPIDController::step(inewReading);
+}
+} // namespace okapi
@@ -0,0 +1,91 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/motionProfile.hpp"
+#include "okapi/api/util/logging.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace okapi {
+MotionProfile::MotionProfile(const double idistance,
+                             const double imaxVelocity,
+                             const double imaxAcceleration,
+                             const Shape ishape)
+  : shape(ishape), direction(idistance < 0 ? -1 : 1), distance(std::abs(idistance)) {
+  if (imaxVelocity <= 0 || imaxAcceleration <= 0) {
+    const auto logger = Logger::getDefaultLogger();
+    std::string msg = "MotionProfile: The max velocity and acceleration must be greater than zero.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  // An S-curve ramp averages half its peak acceleration.
+  const double rampScale = shape == Shape::sCurve ? 2 : 1;
+
+  cruiseVelocity = imaxVelocity;
+  rampTime = rampScale * cruiseVelocity / imaxAcceleration;
+
+  // Each ramp covers half of the cruise velocity times the ramp time.
+  if (cruiseVelocity * rampTime > distance) {
+    cruiseVelocity = std::sqrt(distance * imaxAcceleration / rampScale);
+    rampTime = rampScale * cruiseVelocity / imaxAcceleration;
+    cruiseTime = 0;
+  } else {
+    cruiseTime = (distance - cruiseVelocity * rampTime) / cruiseVelocity;
+  }
+}
+
+MotionProfile::State MotionProfile::get(const QTime itime) const {
+  const double t = itime.convert(second);
+  State out;
+
+  if (t <= 0) {
+    return out;
+  } else if (t < rampTime) {
+    out = ramp(t);
+  } else if (t < rampTime + cruiseTime) {
+    out.position = cruiseVelocity * rampTime / 2 + cruiseVelocity * (t - rampTime);
+    out.velocity = cruiseVelocity;
+  } else if (t < 2 * rampTime + cruiseTime) {
+    // Deceleration mirrors acceleration in time.
+    const State mirrored = ramp(2 * rampTime + cruiseTime - t);
+    out.position = distance - mirrored.position;
+    out.velocity = mirrored.velocity;
+    out.acceleration = -mirrored.acceleration;
+  } else {
+    out.position = distance;
+  }
+
+  out.position *= direction;
+  out.velocity *= direction;
+  out.acceleration *= direction;
+  return out;
+}
+
+QTime MotionProfile::getDuration() const {
+  return (2 * rampTime + cruiseTime) * second;
+}
+
+MotionProfile::State MotionProfile::ramp(const double itime) const {
+  State out;
+  if (rampTime <= 0) {
+    return out;
+  }
+
+  if (shape == Shape::sCurve) {
+    const double omega = 2 * 1_pi / rampTime;
+    out.acceleration = cruiseVelocity / rampTime * (1 - std::cos(omega * itime));
+    out.velocity = cruiseVelocity * (itime / rampTime - std::sin(omega * itime) / (2 * 1_pi));
+    out.position = cruiseVelocity * (itime * itime / (2 * rampTime) -
+                                     (1 - std::cos(omega * itime)) * rampTime / (4 * 1_pi * 1_pi));
+  } else {
+    out.acceleration = cruiseVelocity / rampTime;
+    out.velocity = out.acceleration * itime;
+    out.position = out.acceleration * itime * itime / 2;
+  }
+
+  return out;
+}
+} // namespace okapi
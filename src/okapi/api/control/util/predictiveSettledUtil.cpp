@@ -0,0 +1,115 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/predictiveSettledUtil.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace okapi {
+PredictiveSettledUtil::PredictiveSettledUtil(std::unique_ptr<AbstractTimer> iatTargetTimer,
+                                             const double iatTargetError,
+                                             const double iatTargetDerivative,
+                                             const QTime iatTargetTime,
+                                             const QTime ipredictionHorizon,
+                                             const double icaptureError,
+                                             const std::size_t ifitSamples,
+                                             const double iminFitQuality)
+  : SettledUtil(std::move(iatTargetTimer), iatTargetError, iatTargetDerivative, iatTargetTime),
+    predictionHorizon(ipredictionHorizon),
+    captureError(icaptureError > 0 ? icaptureError : 3 * iatTargetError),
+    fitSamples(std::clamp<std::size_t>(ifitSamples, 3, maxFitSamples)),
+    minFitQuality(iminFitQuality) {
+}
+
+PredictiveSettledUtil::~PredictiveSettledUtil() = default;
+
+bool PredictiveSettledUtil::isSettled(const double ierror) {
+  // Always run the SettledUtil rules so its timer and last error stay current.
+  const bool settled = SettledUtil::isSettled(ierror);
+  const bool predicted = predictSettled(ierror);
+  return settled || predicted;
+}
+
+void PredictiveSettledUtil::reset() {
+  SettledUtil::reset();
+  count = 0;
+  index = 0;
+  lastSign = 0;
+  decayRate = 0;
+}
+
+double PredictiveSettledUtil::getDecayRate() const {
+  return decayRate;
+}
+
+bool PredictiveSettledUtil::predictSettled(const double ierror) {
+  const double sign = ierror > 0 ? 1 : (ierror < 0 ? -1 : 0);
+
+  // An overshoot or an exact zero breaks the exponential model, so start the fit again.
+  if (sign != lastSign) {
+    count = 0;
+    index = 0;
+    lastSign = sign;
+    decayRate = 0;
+  }
+
+  if (sign == 0) {
+    return false;
+  }
+
+  const double now = atTargetTimer->millis().convert(second);
+
+  // The controller can poll faster than it steps. Repeated samples carry no information.
+  if (count > 0 && now <= times[(index + fitSamples - 1) % fitSamples]) {
+    return false;
+  }
+
+  times[index] = now;
+  logErrors[index] = std::log(std::abs(ierror));
+  index = (index + 1) % fitSamples;
+  if (count < fitSamples) {
+    count++;
+  }
+
+  if (count < fitSamples || std::abs(ierror) > captureError) {
+    return false;
+  }
+
+  double meanT = 0, meanL = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    meanT += times[i] - now;
+    meanL += logErrors[i];
+  }
+  meanT /= count;
+  meanL /= count;
+
+  double sTT = 0, sTL = 0, sLL = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    const double dt = times[i] - now - meanT;
+    const double dl = logErrors[i] - meanL;
+    sTT += dt * dt;
+    sTL += dt * dl;
+    sLL += dl * dl;
+  }
+
+  if (sTT <= 0 || sLL <= 0) {
+    return false;
+  }
+
+  const double slope = sTL / sTT;
+  const double fitQuality = sTL * sTL / (sTT * sLL);
+  if (slope >= 0 || fitQuality < minFitQuality) {
+    decayRate = 0;
+    return false;
+  }
+
+  decayRate = -slope;
+
+  // Predict from the fitted line rather than the last sample, which is noisier.
+  const double fittedLog = meanL + slope * -meanT;
+  const double predicted = std::exp(fittedLog - decayRate * predictionHorizon.convert(second));
+  return predicted <= atTargetError;
+}
+} // namespace okapi
@@ -0,0 +1,227 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/relayAutotuner.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace okapi {
+RelayAutotuner::RelayAutotuner(const std::shared_ptr<ControllerInput<double>> &iinput,
+                               const std::shared_ptr<ControllerOutput<double>> &ioutput,
+                               const TimeUtil &itimeUtil,
+                               const double isetpoint,
+                               const double irelayAmplitude,
+                               const double ibias,
+                               const double ihysteresis,
+                               const std::size_t inumCycles,
+                               const std::size_t isettleCycles,
+                               const QTime itimeout,
+                               const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    timeUtil(itimeUtil),
+    input(iinput),
+    output(ioutput),
+    setpoint(isetpoint),
+    relayAmplitude(std::abs(irelayAmplitude)),
+    bias(ibias),
+    hysteresis(std::abs(ihysteresis)),
+    numCycles(std::max<std::size_t>(inumCycles, 1)),
+    settleCycles(isettleCycles),
+    timeout(itimeout) {
+}
+
+RelayAutotuner::~RelayAutotuner() = default;
+
+RelayAutotuner::Result RelayAutotuner::autotune() {
+  LOG_INFO("RelayAutotuner: Starting around " + std::to_string(setpoint) + " with amplitude " +
+           std::to_string(relayAmplitude) + " and bias " + std::to_string(bias));
+
+  auto rate = timeUtil.getRate();
+  auto timer = timeUtil.getTimer();
+  const QTime start = timer->millis();
+
+  struct Cycle {
+    QTime period;
+    QTime highTime;
+    double amplitude;
+    double mean;
+  };
+  std::vector<Cycle> cycles;
+  cycles.reserve(numCycles);
+
+  bool relayHigh = setpoint - input->controllerGet() > 0;
+  bool sawRisingSwitch = false;
+  std::size_t skipped = 0;
+  QTime cycleStart = start;
+  QTime highStart = start;
+  QTime highTime = 0_ms;
+  double cycleMax = std::numeric_limits<double>::lowest();
+  double cycleMin = std::numeric_limits<double>::max();
+  double cycleSum = 0;
+  std::size_t cycleSamples = 0;
+
+  while (cycles.size() < numCycles && timer->millis() - start < timeout) {
+    const double reading = input->controllerGet();
+    const QTime now = timer->millis();
+
+    cycleMax = std::max(cycleMax, reading);
+    cycleMin = std::min(cycleMin, reading);
+    cycleSum += reading;
+    cycleSamples++;
+
+    if (relayHigh && reading > setpoint + hysteresis) {
+      relayHigh = false;
+      highTime += now - highStart;
+    } else if (!relayHigh && reading < setpoint - hysteresis) {
+      relayHigh = true;
+      highStart = now;
+
+      // A cycle runs from one switch to high to the next.
+      if (sawRisingSwitch) {
+        if (skipped < settleCycles) {
+          skipped++;
+        } else {
+          cycles.push_back({now - cycleStart,
+                            highTime,
+                            (cycleMax - cycleMin) / 2,
+                            cycleSum / static_cast<double>(cycleSamples)});
+        }
+      }
+
+      sawRisingSwitch = true;
+      cycleStart = now;
+      highTime = 0_ms;
+      cycleMax = std::numeric_limits<double>::lowest();
+      cycleMin = std::numeric_limits<double>::max();
+      cycleSum = 0;
+      cycleSamples = 0;
+    }
+
+    output->controllerSet(relayHigh ? bias + relayAmplitude : bias - relayAmplitude);
+    rate->delayUntil(loopDelta);
+  }
+
+  output->controllerSet(0);
+
+  Result result;
+  result.cycles = cycles.size();
+  if (cycles.empty()) {
+    LOG_WARN_S("RelayAutotuner: No complete cycles before the timeout. Increase the relay "
+               "amplitude or the timeout.");
+    return result;
+  }
+
+  double periodSum = 0, amplitudeSum = 0, meanSum = 0, asymmetrySum = 0;
+  double periodMax = 0, periodMin = std::numeric_limits<double>::max();
+  double amplitudeMax = 0, amplitudeMin = std::numeric_limits<double>::max();
+  for (const auto &cycle : cycles) {
+    const double period = cycle.period.convert(second);
+    periodSum += period;
+    periodMax = std::max(periodMax, period);
+    periodMin = std::min(periodMin, period);
+    amplitudeSum += cycle.amplitude;
+    amplitudeMax = std::max(amplitudeMax, cycle.amplitude);
+    amplitudeMin = std::min(amplitudeMin, cycle.amplitude);
+    meanSum += cycle.mean;
+    asymmetrySum += std::abs(2 * (cycle.highTime / cycle.period).getValue() - 1);
+  }
+
+  const auto count = static_cast<double>(cycles.size());
+  const double period = periodSum / count;
+  result.ultimatePeriod = period * second;
+  result.amplitude = amplitudeSum / count;
+  result.meanReading = meanSum / count;
+  result.periodSpread = period > 0 ? (periodMax - periodMin) / period : 0;
+  result.amplitudeSpread =
+    result.amplitude > 0 ? (amplitudeMax - amplitudeMin) / result.amplitude : 0;
+  result.asymmetry = asymmetrySum / count;
+
+  // Describing function of a relay with hysteresis.
+  if (result.amplitude > hysteresis) {
+    result.ultimateGain = 4 * relayAmplitude /
+                          (pi * std::sqrt(ipow(result.amplitude, 2) - ipow(hysteresis, 2)));
+  }
+
+  result.valid = result.cycles == numCycles && result.ultimateGain > 0 && period > 0;
+
+  LOG_INFO("RelayAutotuner: Ku=" + std::to_string(result.ultimateGain) +
+           " Pu=" + std::to_string(period) + " s, amplitude " + std::to_string(result.amplitude) +
+           " over " + std::to_string(result.cycles) + " cycles");
+
+  if (result.periodSpread > 0.1 || result.amplitudeSpread > 0.1) {
+    LOG_WARN("RelayAutotuner: The oscillation was inconsistent (period spread " +
+             std::to_string(result.periodSpread) + ", amplitude spread " +
+             std::to_string(result.amplitudeSpread) +
+             "). Increase the hysteresis or the number of settle cycles.");
+  }
+
+  if (result.asymmetry > 0.2) {
+    LOG_WARN("RelayAutotuner: The relay was asymmetric (" + std::to_string(result.asymmetry) +
+             "). Adjust the bias to the output which holds the setpoint.");
+  }
+
+  return result;
+}
+
+void RelayAutotuner::ruleGains(const Result &iresult,
+                               const TuningRule irule,
+                               double &okP,
+                               double &oTi,
+                               double &oTd) {
+  const double ku = iresult.ultimateGain;
+  const double pu = iresult.ultimatePeriod.convert(second);
+
+  switch (irule) {
+  case TuningRule::zieglerNichols:
+    okP = 0.6 * ku;
+    oTi = pu / 2;
+    oTd = pu / 8;
+    break;
+
+  case TuningRule::tyreusLuyben:
+    okP = ku / 2.2;
+    oTi = 2.2 * pu;
+    oTd = pu / 6.3;
+    break;
+
+  case TuningRule::noOvershoot:
+    okP = 0.2 * ku;
+    oTi = pu / 2;
+    oTd = pu / 3;
+    break;
+  }
+}
+
+IterativePosPIDController::Gains RelayAutotuner::getPosGains(const Result &iresult,
+                                                             const TuningRule irule) {
+  if (!iresult.valid) {
+    return {};
+  }
+
+  double kP, Ti, Td;
+  ruleGains(iresult, irule, kP, Ti, Td);
+  return {kP, kP / Ti, kP * Td, 0};
+}
+
+IterativeVelPIDController::Gains RelayAutotuner::getVelGains(const Result &iresult,
+                                                             const double ibias,
+                                                             const QTime isampleTime,
+                                                             const TuningRule irule) {
+  if (!iresult.valid) {
+    return {};
+  }
+
+  double kP, Ti, Td;
+  ruleGains(iresult, irule, kP, Ti, Td);
+
+  // Velocity form: the change in output is kP * (change in error) + kI * dt * error.
+  const double dt = isampleTime.convert(second);
+  const double kF = iresult.meanReading != 0 ? ibias / iresult.meanReading : 0;
+  return {kP / Ti * dt, kP, kF, 0};
+}
+} // namespace okapi
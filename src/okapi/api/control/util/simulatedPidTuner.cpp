@@ -0,0 +1,355 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/simulatedPidTuner.hpp"
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/util/abstractRate.hpp"
+#include "okapi/api/util/abstractTimer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace okapi {
+namespace {
+/**
+ * A timer over a tick count which the simulation advances. Time differences are computed from
+ * whole ticks so a controller sampled every tick sees exactly one loop period each step.
+ */
+class VirtualTimer : public AbstractTimer {
+  public:
+  VirtualTimer(std::shared_ptr<const std::uint64_t> iticks, const QTime iloopDelta)
+    : AbstractTimer(*iticks * iloopDelta),
+      ticks(std::move(iticks)),
+      loopDelta(iloopDelta),
+      firstTick(*ticks),
+      lastTick(*ticks) {
+  }
+
+  QTime millis() const override {
+    return static_cast<double>(*ticks) * loopDelta;
+  }
+
+  QTime getDt() override {
+    const QTime dt = readDt();
+    lastTick = *ticks;
+    return dt;
+  }
+
+  QTime readDt() const override {
+    return since(lastTick);
+  }
+
+  QTime getStartingTime() const override {
+    return static_cast<double>(firstTick) * loopDelta;
+  }
+
+  QTime getDtFromStart() const override {
+    return since(firstTick);
+  }
+
+  void placeMark() override {
+    markTick = *ticks;
+  }
+
+  QTime clearMark() override {
+    const QTime dt = getDtFromMark();
+    markTick = 0;
+    return dt;
+  }
+
+  void placeHardMark() override {
+    if (hardMarkTick == 0) {
+      hardMarkTick = *ticks;
+    }
+  }
+
+  QTime clearHardMark() override {
+    const QTime dt = getDtFromHardMark();
+    hardMarkTick = 0;
+    return dt;
+  }
+
+  QTime getDtFromMark() const override {
+    return markTick == 0 ? 0_ms : since(markTick);
+  }
+
+  QTime getDtFromHardMark() const override {
+    return hardMarkTick == 0 ? 0_ms : since(hardMarkTick);
+  }
+
+  protected:
+  std::shared_ptr<const std::uint64_t> ticks;
+  QTime loopDelta;
+  std::uint64_t firstTick;
+  std::uint64_t lastTick;
+  std::uint64_t markTick{0};
+  std::uint64_t hardMarkTick{0};
+
+  QTime since(const std::uint64_t itick) const {
+    return static_cast<double>(*ticks - itick) * loopDelta;
+  }
+};
+
+/**
+ * The simulation advances virtual time itself, so there is nothing to wait for.
+ */
+class VirtualRate : public AbstractRate {
+  public:
+  void delay(QFrequency) override {
+  }
+
+  void delayUntil(QTime) override {
+  }
+
+  void delayUntil(uint32_t) override {
+  }
+};
+
+struct WorkQueue {
+  const SimulatedPIDTuner *tuner;
+  const std::vector<PIDTuner::Output> *gains;
+  std::vector<double> *errors;
+  std::atomic_size_t next{0};
+  std::atomic_size_t done{0};
+
+  void work() {
+    for (std::size_t i = next++; i < gains->size(); i = next++) {
+      (*errors)[i] = tuner->evaluate((*gains)[i]);
+      done++;
+    }
+  }
+
+  static void trampoline(void *iqueue) {
+    static_cast<WorkQueue *>(iqueue)->work();
+  }
+};
+} // namespace
+
+SimulatedPIDTuner::SimulatedPIDTuner(const Supplier<Plant> &iplantSupplier,
+                                     const TimeUtil &itimeUtil,
+                                     const QTime itimeout,
+                                     const double igoal,
+                                     const double ikPMin,
+                                     const double ikPMax,
+                                     const double ikIMin,
+                                     const double ikIMax,
+                                     const double ikDMin,
+                                     const double ikDMax,
+                                     const std::size_t inumIterations,
+                                     const std::size_t inumParticles,
+                                     const double ikSettle,
+                                     const double ikITAE,
+                                     const std::size_t inumThreads,
+                                     const std::uint32_t iseed,
+                                     const QTime iloopDelta,
+                                     const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    timeUtil(itimeUtil),
+    plantSupplier(iplantSupplier),
+    timeout(itimeout),
+    goal(igoal),
+    kPMin(ikPMin),
+    kPMax(ikPMax),
+    kIMin(ikIMin),
+    kIMax(ikIMax),
+    kDMin(ikDMin),
+    kDMax(ikDMax),
+    numIterations(inumIterations),
+    numParticles(inumParticles),
+    kSettle(ikSettle),
+    kITAE(ikITAE),
+    numThreads(std::max<std::size_t>(inumThreads, 1)),
+    loopDelta(iloopDelta),
+    rng(iseed) {
+}
+
+SimulatedPIDTuner::~SimulatedPIDTuner() = default;
+
+std::vector<SimulatedPIDTuner::Candidate>
+SimulatedPIDTuner::autotune(const std::size_t inumCandidates) {
+  LOG_INFO("SimulatedPIDTuner: Running " + std::to_string(numIterations) + " iterations of " +
+           std::to_string(numParticles) + " particles on " + std::to_string(numThreads) +
+           " threads.");
+
+  std::uniform_real_distribution<double> kPDist(kPMin, kPMax);
+  std::uniform_real_distribution<double> kIDist(kIMin, kIMax);
+  std::uniform_real_distribution<double> kDDist(kDMin, kDMax);
+  std::uniform_real_distribution<double> unit(0, 1);
+
+  std::vector<ParticleSet> particles;
+  particles.reserve(numParticles);
+  for (std::size_t i = 0; i < numParticles; i++) {
+    const double kP = kPDist(rng), kI = kIDist(rng), kD = kDDist(rng);
+    particles.push_back(
+      {{kP, 0, kP}, {kI, 0, kI}, {kD, 0, kD}, std::numeric_limits<double>::max()});
+  }
+
+  // Every position a particle has visited, so the best few distinct gains can be returned.
+  std::vector<Candidate> visited;
+  visited.reserve(numParticles * numIterations);
+
+  ParticleSet globalBest{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, std::numeric_limits<double>::max()};
+  std::vector<double> errors(numParticles);
+
+  for (std::size_t iteration = 0; iteration < numIterations; iteration++) {
+    evaluateAll(particles, errors);
+
+    for (std::size_t i = 0; i < numParticles; i++) {
+      ParticleSet &particle = particles[i];
+      visited.push_back({{particle.kP.pos, particle.kI.pos, particle.kD.pos}, errors[i]});
+
+      if (errors[i] < particle.bestError) {
+        particle.kP.best = particle.kP.pos;
+        particle.kI.best = particle.kI.pos;
+        particle.kD.best = particle.kD.pos;
+        particle.bestError = errors[i];
+
+        if (errors[i] < globalBest.bestError) {
+          globalBest = particle;
+        }
+      }
+    }
+
+    LOG_DEBUG("SimulatedPIDTuner: Iteration " + std::to_string(iteration) + " best error " +
+              std::to_string(globalBest.bestError));
+
+    for (auto &particle : particles) {
+      auto move = [&](Particle &ip, const Particle &iglobal, const double imin, const double imax) {
+        ip.vel = inertia * ip.vel + confSelf * (ip.best - ip.pos) * unit(rng) +
+                 confSwarm * (iglobal.best - ip.pos) * unit(rng);
+        ip.pos = std::clamp(ip.pos + ip.vel, imin, imax);
+      };
+
+      move(particle.kP, globalBest.kP, kPMin, kPMax);
+      move(particle.kI, globalBest.kI, kIMin, kIMax);
+      move(particle.kD, globalBest.kD, kDMin, kDMax);
+    }
+  }
+
+  std::sort(visited.begin(), visited.end(), [](const Candidate &a, const Candidate &b) {
+    return a.error < b.error;
+  });
+
+  std::vector<Candidate> candidates;
+  for (const auto &candidate : visited) {
+    if (candidates.size() >= inumCandidates) {
+      break;
+    }
+
+    const bool duplicate =
+      std::any_of(candidates.begin(), candidates.end(), [&](const Candidate &c) {
+        return c.gains.kP == candidate.gains.kP && c.gains.kI == candidate.gains.kI &&
+               c.gains.kD == candidate.gains.kD;
+      });
+
+    if (!duplicate) {
+      candidates.push_back(candidate);
+    }
+  }
+
+  if (!candidates.empty()) {
+    LOG_INFO("SimulatedPIDTuner: Best kP=" + std::to_string(candidates[0].gains.kP) +
+             " kI=" + std::to_string(candidates[0].gains.kI) +
+             " kD=" + std::to_string(candidates[0].gains.kD) +
+             " error=" + std::to_string(candidates[0].error));
+  }
+
+  return candidates;
+}
+
+double SimulatedPIDTuner::evaluate(const PIDTuner::Output &igains) const {
+  auto ticks = std::make_shared<std::uint64_t>(1);
+  const QTime delta = loopDelta;
+  const auto makeTimer = [ticks, delta]() {
+    return std::unique_ptr<AbstractTimer>(std::make_unique<VirtualTimer>(ticks, delta));
+  };
+
+  const TimeUtil virtualTime(
+    Supplier<std::unique_ptr<AbstractTimer>>(makeTimer),
+    Supplier<std::unique_ptr<AbstractRate>>(
+      []() { return std::unique_ptr<AbstractRate>(std::make_unique<VirtualRate>()); }),
+    Supplier<std::unique_ptr<SettledUtil>>(
+      [makeTimer]() { return std::make_unique<SettledUtil>(makeTimer()); }));
+
+  // Step responses run concurrently, so they must not share the default logger.
+  IterativePosPIDController controller(igains.kP,
+                                       igains.kI,
+                                       igains.kD,
+                                       0,
+                                       virtualTime,
+                                       std::make_unique<PassthroughFilter>(),
+                                       std::make_shared<Logger>());
+  controller.setSampleTime(loopDelta);
+  controller.setTarget(goal);
+
+  Plant plant = plantSupplier.get();
+  const auto steps = static_cast<std::uint64_t>(std::ceil((timeout / loopDelta).getValue()));
+  const double dt = loopDelta.convert(second);
+
+  double reading = plant(0);
+  double itae = 0;
+  double settledTime = timeout.convert(second);
+  for (std::uint64_t step = 1; step <= steps; step++) {
+    ++*ticks;
+    reading = plant(controller.step(reading));
+
+    const double t = static_cast<double>(step) * dt;
+    itae += t * std::abs(controller.getError()) * dt;
+
+    if (controller.isSettled()) {
+      settledTime = t;
+      break;
+    }
+  }
+
+  return kSettle * settledTime + kITAE * itae;
+}
+
+void SimulatedPIDTuner::evaluateAll(const std::vector<ParticleSet> &iparticles,
+                                    std::vector<double> &oerrors) {
+  std::vector<PIDTuner::Output> gains;
+  gains.reserve(iparticles.size());
+  for (const auto &particle : iparticles) {
+    gains.push_back({particle.kP.pos, particle.kI.pos, particle.kD.pos});
+  }
+
+  WorkQueue queue;
+  queue.tuner = this;
+  queue.gains = &gains;
+  queue.errors = &oerrors;
+
+  std::vector<std::unique_ptr<CrossplatformThread>> workers;
+  for (std::size_t i = 1; i < std::min(numThreads, gains.size()); i++) {
+    workers.push_back(std::make_unique<CrossplatformThread>(
+      &WorkQueue::trampoline, &queue, "SimulatedPIDTuner"));
+  }
+
+  queue.work();
+
+  // The caller has run out of particles, but workers can still be finishing theirs.
+  auto rate = timeUtil.getRate();
+  while (queue.done.load() < gains.size()) {
+    rate->delayUntil(1_ms);
+  }
+
+  workers.clear();
+}
+
+Supplier<SimulatedPIDTuner::Plant> SimulatedPIDTuner::flywheelPlant(
+  const std::function<std::unique_ptr<FlywheelSimulator>()> &imakeSimulator,
+  const QTime iloopDelta) {
+  const double timestep = iloopDelta.convert(second);
+  return Supplier<Plant>([imakeSimulator, timestep]() {
+    std::shared_ptr<FlywheelSimulator> simulator = imakeSimulator();
+    simulator->setTimestep(timestep);
+    return Plant([simulator](const double ioutput) {
+      return simulator->step(ioutput * simulator->getMaxTorque());
+    });
+  });
+}
+} // namespace okapi
@@ -0,0 +1,259 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/odometry/fusedOdometry.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <cmath>
+
+namespace okapi {
+namespace {
+double wrapAngle(double iangle) {
+  return std::remainder(iangle, 2 * 1_pi);
+}
+} // namespace
+
+FusedOdometry::FusedOdometry(const std::shared_ptr<TimestampedRotarySensor> &ileftEncoder,
+                             const std::shared_ptr<TimestampedRotarySensor> &irightEncoder,
+                             const std::shared_ptr<ContinuousRotarySensor> &iimu,
+                             const std::shared_ptr<AbsolutePositionSensor> &ipositionSensor,
+                             const ChassisScales &ichassisScales,
+                             const FusedOdometryNoise &inoise,
+                             const QTime &iimuLatency,
+                             const QTime &iimuPeriod,
+                             const QTime &ipositionLatency,
+                             const std::shared_ptr<ReadOnlyChassisModel> &imodel,
+                             const std::shared_ptr<Logger> &ilogger)
+  : TimestampedOdometry(ileftEncoder, irightEncoder, ichassisScales, imodel, ilogger),
+    imu(iimu),
+    positionSensor(ipositionSensor),
+    noise(inoise),
+    imuLatency(static_cast<std::uint32_t>(iimuLatency.convert(millisecond))),
+    imuPeriod(static_cast<std::uint32_t>(iimuPeriod.convert(millisecond))),
+    positionLatency(static_cast<std::uint32_t>(ipositionLatency.convert(millisecond))) {
+}
+
+void FusedOdometry::step() {
+  applyRequestedState();
+
+  double leftDiff, rightDiff;
+  if (!readEncoderDiffs(leftDiff, rightDiff)) {
+    return;
+  }
+
+  const double deltaL = leftDiff / chassisScales.straight;
+  const double deltaR = rightDiff / chassisScales.straight;
+  const double distance = (deltaL + deltaR) / 2;
+  const double turn = (deltaL - deltaR) / chassisScales.wheelTrack.convert(meter);
+  predict(x, P, distance, turn);
+
+  const std::uint32_t now = std::max(lastLeft.timestamp, lastRight.timestamp);
+  historyHead = (historyHead + 1) % historySize;
+  history[historyHead] = Entry{now, x, P, distance, turn};
+  historyCount = std::min(historyCount + 1, historySize);
+
+  if (imu) {
+    const double heading = imu->get();
+    // okapi's IMU reports failures as OKAPI_PROS_ERR_F, which is infinite.
+    if (std::isfinite(heading) && heading != OKAPI_PROS_ERR && isNewImuSample(heading, now)) {
+      const double headingRad = heading * degreeToRadian;
+      if (!imuOffsetValid) {
+        imuOffset = x[2] - headingRad;
+        imuOffsetValid = true;
+      }
+
+      correctAt(now - imuLatency,
+                {Measurement::Type::heading, headingRad + imuOffset, 0, 0});
+    }
+  }
+
+  if (positionSensor) {
+    const PositionFix fix = positionSensor->getFix();
+    if (fix.valid) {
+      const double variance = std::pow(fix.stdDev.convert(meter), 2);
+      correctAt(
+        fix.timestamp - positionLatency,
+        {Measurement::Type::position, fix.x.convert(meter), fix.y.convert(meter), variance});
+    }
+  }
+
+  publishState();
+}
+
+void FusedOdometry::applyState(const OdomState &istate) {
+  TimestampedOdometry::applyState(istate);
+  x = {state.x.convert(meter), state.y.convert(meter), state.theta.convert(radian)};
+  P = {};
+  historyCount = 0;
+  imuOffsetValid = false;
+  lastImuValid = false;
+  publishedCovariance.write(P);
+}
+
+bool FusedOdometry::isNewImuSample(const double iheading, const std::uint32_t itime) {
+  if (lastImuValid && iheading == lastImuHeading && itime - lastImuTime < imuPeriod) {
+    return false;
+  }
+
+  lastImuHeading = iheading;
+  lastImuTime = itime;
+  lastImuValid = true;
+  return true;
+}
+
+std::array<double, 9> FusedOdometry::getCovariance() const {
+  return publishedCovariance.read();
+}
+
+void FusedOdometry::predict(Vector &ioX,
+                            Matrix &ioP,
+                            const double idistance,
+                            const double iturn) const {
+  const double avgTheta = ioX[2] + iturn / 2;
+  const double c = std::cos(avgTheta);
+  const double s = std::sin(avgTheta);
+
+  ioX[0] += idistance * c;
+  ioX[1] += idistance * s;
+  ioX[2] += iturn;
+
+  // P = F P F^T + G M G^T, where F = [1 0 a; 0 1 b; 0 0 1] is the state Jacobian and G is the
+  // Jacobian with respect to (distance, turn).
+  const double a = -idistance * s;
+  const double b = idistance * c;
+  const Matrix p = ioP;
+  const double fp20 = p[6], fp21 = p[7], fp22 = p[8];
+  const double fp00 = p[0] + a * fp20, fp01 = p[1] + a * fp21, fp02 = p[2] + a * fp22;
+  const double fp10 = p[3] + b * fp20, fp11 = p[4] + b * fp21, fp12 = p[5] + b * fp22;
+
+  const double mD = noise.distance * std::abs(idistance) + 1e-9;
+  const double mT = noise.turn * std::abs(iturn) +
+                    noise.turnPerDistance * std::abs(idistance) + 1e-9;
+  const double g00 = c, g01 = a / 2;
+  const double g10 = s, g11 = b / 2;
+
+  ioP[0] = fp00 + a * fp02 + g00 * g00 * mD + g01 * g01 * mT;
+  ioP[1] = fp01 + b * fp02 + g00 * g10 * mD + g01 * g11 * mT;
+  ioP[2] = fp02 + g01 * mT;
+  ioP[3] = fp10 + a * fp12 + g10 * g00 * mD + g11 * g01 * mT;
+  ioP[4] = fp11 + b * fp12 + g10 * g10 * mD + g11 * g11 * mT;
+  ioP[5] = fp12 + g11 * mT;
+  ioP[6] = fp20 + a * fp22 + g01 * mT;
+  ioP[7] = fp21 + b * fp22 + g11 * mT;
+  ioP[8] = fp22 + mT;
+}
+
+void FusedOdometry::correctHeading(Vector &ioX, Matrix &ioP, const double iheading) const {
+  const double r = std::pow(noise.imuHeading.convert(radian), 2);
+  const double innovation = wrapAngle(iheading - ioX[2]);
+  const double s = ioP[8] + r;
+  const Vector k{ioP[2] / s, ioP[5] / s, ioP[8] / s};
+
+  for (std::size_t i = 0; i < 3; i++) {
+    ioX[i] += k[i] * innovation;
+  }
+
+  const Matrix p = ioP;
+  for (std::size_t i = 0; i < 3; i++) {
+    for (std::size_t j = 0; j < 3; j++) {
+      ioP[i * 3 + j] = p[i * 3 + j] - k[i] * p[6 + j];
+    }
+  }
+}
+
+void FusedOdometry::correctPosition(Vector &ioX,
+                                    Matrix &ioP,
+                                    const double ix,
+                                    const double iy,
+                                    const double ivariance) const {
+  // S = H P H^T + R is the top left 2x2 block of P plus R.
+  const double s00 = ioP[0] + ivariance, s01 = ioP[1];
+  const double s10 = ioP[3], s11 = ioP[4] + ivariance;
+  const double det = s00 * s11 - s01 * s10;
+  if (std::abs(det) < 1e-12) {
+    return;
+  }
+
+  const double i00 = s11 / det, i01 = -s01 / det;
+  const double i10 = -s10 / det, i11 = s00 / det;
+
+  // K = P H^T S^-1, where P H^T is the first two columns of P.
+  std::array<double, 6> k;
+  for (std::size_t i = 0; i < 3; i++) {
+    const double ph0 = ioP[i * 3], ph1 = ioP[i * 3 + 1];
+    k[i * 2] = ph0 * i00 + ph1 * i10;
+    k[i * 2 + 1] = ph0 * i01 + ph1 * i11;
+  }
+
+  const double v0 = ix - ioX[0];
+  const double v1 = iy - ioX[1];
+  for (std::size_t i = 0; i < 3; i++) {
+    ioX[i] += k[i * 2] * v0 + k[i * 2 + 1] * v1;
+  }
+
+  const Matrix p = ioP;
+  for (std::size_t i = 0; i < 3; i++) {
+    for (std::size_t j = 0; j < 3; j++) {
+      ioP[i * 3 + j] = p[i * 3 + j] - k[i * 2] * p[j] - k[i * 2 + 1] * p[3 + j];
+    }
+  }
+}
+
+void FusedOdometry::correct(Vector &ioX, Matrix &ioP, const Measurement &imeasurement) const {
+  if (imeasurement.type == Measurement::Type::heading) {
+    correctHeading(ioX, ioP, imeasurement.a);
+  } else {
+    correctPosition(ioX, ioP, imeasurement.a, imeasurement.b, imeasurement.variance);
+  }
+}
+
+void FusedOdometry::correctAt(const std::uint32_t itimestamp, const Measurement &imeasurement) {
+  // Find the newest entry at or before the measurement time.
+  std::size_t age = 0;
+  while (age < historyCount &&
+         static_cast<std::int32_t>(history[(historyHead + historySize - age) % historySize]
+                                     .timestamp -
+                                   itimestamp) > 0) {
+    age++;
+  }
+
+  if (age >= historyCount) {
+    LOG_DEBUG_S("FusedOdometry: Measurement is older than the history, dropping it.");
+    return;
+  }
+
+  std::size_t index = (historyHead + historySize - age) % historySize;
+  Entry &entry = history[index];
+  if (entry.measurementCount == maxMeasurements) {
+    LOG_DEBUG_S("FusedOdometry: Too many measurements for one step, dropping one.");
+    return;
+  }
+
+  entry.measurements[entry.measurementCount++] = imeasurement;
+  correct(entry.state, entry.covariance, imeasurement);
+
+  // Replay the newer predictions on top of the corrected entry, along with the measurements
+  // already applied to them.
+  for (; age > 0; age--) {
+    const std::size_t next = (index + 1) % historySize;
+    Entry &newer = history[next];
+    newer.state = history[index].state;
+    newer.covariance = history[index].covariance;
+    predict(newer.state, newer.covariance, newer.distance, newer.turn);
+    for (std::size_t i = 0; i < newer.measurementCount; i++) {
+      correct(newer.state, newer.covariance, newer.measurements[i]);
+    }
+    index = next;
+  }
+
+  x = history[historyHead].state;
+  P = history[historyHead].covariance;
+}
+
+void FusedOdometry::publishState() {
+  state = OdomState{x[0] * meter, x[1] * meter, x[2] * radian};
+  publish();
+  publishedCovariance.write(P);
+}
+} // namespace okapi
@@ -0,0 +1,175 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/odometry/timestampedOdometry.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace okapi {
+TimestampedOdometry::TimestampedOdometry(
+  const std::shared_ptr<TimestampedRotarySensor> &ileftEncoder,
+  const std::shared_ptr<TimestampedRotarySensor> &irightEncoder,
+  const ChassisScales &ichassisScales,
+  const std::shared_ptr<ReadOnlyChassisModel> &imodel,
+  const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    leftEncoder(ileftEncoder),
+    rightEncoder(irightEncoder),
+    model(imodel),
+    chassisScales(ichassisScales),
+    requestedScales(ichassisScales) {
+}
+
+void TimestampedOdometry::setScales(const ChassisScales &ichassisScales) {
+  std::lock_guard<CrossplatformMutex> lock(scalesMutex);
+  requestedScales = ichassisScales;
+  scalesRequested.store(true, std::memory_order_release);
+}
+
+void TimestampedOdometry::step() {
+  applyRequestedState();
+
+  double leftDiff, rightDiff;
+  if (readEncoderDiffs(leftDiff, rightDiff)) {
+    state = odomMathStep(leftDiff, rightDiff);
+    publish();
+  }
+}
+
+void TimestampedOdometry::applyRequestedState() {
+  if (scalesRequested.load(std::memory_order_acquire)) {
+    std::lock_guard<CrossplatformMutex> lock(scalesMutex);
+    chassisScales = requestedScales;
+    scalesRequested.store(false, std::memory_order_release);
+  }
+
+  // If setState() is called again while this one is applied, the version is newer than the one
+  // read here, so the newer state stays pending and is applied on the next step.
+  const std::uint32_t version = requestedVersion.load(std::memory_order_acquire);
+  if (version != appliedVersion.load(std::memory_order_relaxed)) {
+    applyState(requestedState.read());
+    publish();
+    appliedVersion.store(version, std::memory_order_release);
+  }
+}
+
+void TimestampedOdometry::applyState(const OdomState &istate) {
+  state = istate;
+}
+
+void TimestampedOdometry::publish() {
+  published.write(Snapshot{state,
+                           linearVelocity,
+                           angularVelocity,
+                           std::max(lastLeft.timestamp, lastRight.timestamp)});
+}
+
+bool TimestampedOdometry::readEncoderDiffs(double &oleftDiff, double &orightDiff) {
+  const TimestampedReading left = leftEncoder->getTimestamped();
+  const TimestampedReading right = rightEncoder->getTimestamped();
+
+  if (left.value == OKAPI_PROS_ERR || right.value == OKAPI_PROS_ERR) {
+    LOG_WARN_S("TimestampedOdometry: Failed to read an encoder, skipping this step.");
+    return false;
+  }
+
+  if (!hasLastReading) {
+    lastLeft = left;
+    lastRight = right;
+    hasLastReading = true;
+    return false;
+  }
+
+  // Only integrate once both sides have a new sample so the two wheel deltas cover the same span
+  // of time.
+  if (left.timestamp == lastLeft.timestamp || right.timestamp == lastRight.timestamp) {
+    return false;
+  }
+
+  oleftDiff = left.value - lastLeft.value;
+  orightDiff = right.value - lastRight.value;
+  const std::uint32_t leftDt = left.timestamp - lastLeft.timestamp;
+  const std::uint32_t rightDt = right.timestamp - lastRight.timestamp;
+  lastLeft = left;
+  lastRight = right;
+
+  if (std::abs(oleftDiff) > maximumTickDiff || std::abs(orightDiff) > maximumTickDiff) {
+    LOG_ERROR("TimestampedOdometry: A tick diff (" + std::to_string(oleftDiff) + ", " +
+              std::to_string(orightDiff) + ") was greater than the maximum allowable diff (" +
+              std::to_string(maximumTickDiff) + "). Skipping this odometry step.");
+    return false;
+  }
+
+  const double leftSpeed = oleftDiff / chassisScales.straight / (leftDt / 1000.0);
+  const double rightSpeed = orightDiff / chassisScales.straight / (rightDt / 1000.0);
+  linearVelocity = (leftSpeed + rightSpeed) / 2 * mps;
+  angularVelocity = (leftSpeed - rightSpeed) / chassisScales.wheelTrack.convert(meter) * radps;
+  return true;
+}
+
+OdomState TimestampedOdometry::odomMathStep(const double ileftDiff,
+                                            const double irightDiff) const {
+  const double deltaL = ileftDiff / chassisScales.straight;
+  const double deltaR = irightDiff / chassisScales.straight;
+  const double deltaTheta = (deltaL - deltaR) / chassisScales.wheelTrack.convert(meter);
+
+  // Arc length to chord length. The series form avoids dividing by a vanishing deltaTheta.
+  const double halfTheta = deltaTheta / 2;
+  const double chordScale = std::abs(halfTheta) < 1e-6
+                              ? 1 - halfTheta * halfTheta / 6
+                              : std::sin(halfTheta) / halfTheta;
+  const double chord = (deltaL + deltaR) / 2 * chordScale;
+  const double avgTheta = state.theta.convert(radian) + halfTheta;
+
+  return OdomState{state.x + chord * std::cos(avgTheta) * meter,
+                   state.y + chord * std::sin(avgTheta) * meter,
+                   state.theta + deltaTheta * radian};
+}
+
+OdomState TimestampedOdometry::getState(const StateMode &imode) const {
+  const bool pending = requestedVersion.load(std::memory_order_acquire) !=
+                       appliedVersion.load(std::memory_order_acquire);
+  const OdomState current = pending ? requestedState.read() : published.read().state;
+  if (imode == StateMode::FRAME_TRANSFORMATION) {
+    return current;
+  } else {
+    return OdomState{current.y, current.x, current.theta};
+  }
+}
+
+void TimestampedOdometry::setState(const OdomState &istate, const StateMode &imode) {
+  LOG_DEBUG("State set to: " + istate.str());
+  if (imode == StateMode::FRAME_TRANSFORMATION) {
+    requestedState.write(istate);
+  } else {
+    requestedState.write(OdomState{istate.y, istate.x, istate.theta});
+  }
+  requestedVersion.fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::shared_ptr<ReadOnlyChassisModel> TimestampedOdometry::getModel() {
+  return model;
+}
+
+ChassisScales TimestampedOdometry::getScales() {
+  std::lock_guard<CrossplatformMutex> lock(scalesMutex);
+  return requestedScales;
+}
+
+QTime TimestampedOdometry::getStateTime() const {
+  return published.read().time * millisecond;
+}
+
+QSpeed TimestampedOdometry::getLinearVelocity() const {
+  return published.read().linearVelocity;
+}
+
+QAngularSpeed TimestampedOdometry::getAngularVelocity() const {
+  return published.read().angularVelocity;
+}
+} // namespace okapi
@@ -0,0 +1,127 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/util/allocationCounter.hpp"
+
+#if defined(THREADS_STD) && defined(OKAPI_COUNT_ALLOCATIONS)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> deallocations{0};
+
+void *countedAllocate(std::size_t isize) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(isize == 0 ? 1 : isize);
+}
+
+void *countedAllocate(std::size_t isize, std::align_val_t ialign) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<std::size_t>(ialign);
+  // aligned_alloc needs the size to be a multiple of the alignment.
+  return std::aligned_alloc(align, (isize + align - 1) / align * align);
+}
+
+void countedFree(void *iptr) noexcept {
+  if (iptr) {
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(iptr);
+  }
+}
+
+void *orThrow(void *iptr) {
+  if (!iptr) {
+    throw std::bad_alloc();
+  }
+  return iptr;
+}
+} // namespace
+
+void *operator new(std::size_t isize) {
+  return orThrow(countedAllocate(isize));
+}
+
+void *operator new[](std::size_t isize) {
+  return orThrow(countedAllocate(isize));
+}
+
+void *operator new(std::size_t isize, const std::nothrow_t &) noexcept {
+  return countedAllocate(isize);
+}
+
+void *operator new[](std::size_t isize, const std::nothrow_t &) noexcept {
+  return countedAllocate(isize);
+}
+
+void *operator new(std::size_t isize, std::align_val_t ialign) {
+  return orThrow(countedAllocate(isize, ialign));
+}
+
+void *operator new[](std::size_t isize, std::align_val_t ialign) {
+  return orThrow(countedAllocate(isize, ialign));
+}
+
+void operator delete(void *iptr) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete[](void *iptr) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete(void *iptr, std::size_t) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete[](void *iptr, std::size_t) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete(void *iptr, const std::nothrow_t &) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete[](void *iptr, const std::nothrow_t &) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete(void *iptr, std::align_val_t) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete[](void *iptr, std::align_val_t) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete(void *iptr, std::size_t, std::align_val_t) noexcept {
+  countedFree(iptr);
+}
+
+void operator delete[](void *iptr, std::size_t, std::align_val_t) noexcept {
+  countedFree(iptr);
+}
+
+namespace okapi {
+std::size_t AllocationCounter::getAllocations() noexcept {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocationCounter::getDeallocations() noexcept {
+  return deallocations.load(std::memory_order_relaxed);
+}
+} // namespace okapi
+#else
+namespace okapi {
+std::size_t AllocationCounter::getAllocations() noexcept {
+  return 0;
+}
+
+std::size_t AllocationCounter::getDeallocations() noexcept {
+  return 0;
+}
+} // namespace okapi
+#endif
@@ -0,0 +1,75 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/chassis/controller/eventChassisControllerPid.hpp"
+
+namespace okapi {
+EventChassisControllerPID::EventChassisControllerPID(
+  TimeUtil itimeUtil,
+  std::shared_ptr<ChassisModel> imodel,
+  std::unique_ptr<IterativePosPIDController> idistanceController,
+  std::unique_ptr<IterativePosPIDController> iturnController,
+  std::unique_ptr<IterativePosPIDController> iangleController,
+  const AbstractMotor::GearsetRatioPair &igearset,
+  const ChassisScales &iscales,
+  std::shared_ptr<Logger> ilogger)
+  : SteppedChassisControllerPID(std::move(itimeUtil),
+                                std::move(imodel),
+                                std::move(idistanceController),
+                                std::move(iturnController),
+                                std::move(iangleController),
+                                igearset,
+                                iscales,
+                                std::move(ilogger),
+                                "EventChassisControllerPID") {
+}
+
+EventChassisControllerPID::~EventChassisControllerPID() {
+  stopThread();
+}
+
+void EventChassisControllerPID::moveRawAsync(const double itarget) {
+  SteppedChassisControllerPID::moveRawAsync(itarget);
+  notifyLoop();
+}
+
+void EventChassisControllerPID::moveDistanceAsync(const QLength itarget) {
+  SteppedChassisControllerPID::moveDistanceAsync(itarget);
+  notifyLoop();
+}
+
+void EventChassisControllerPID::turnRawAsync(const double idegTarget) {
+  SteppedChassisControllerPID::turnRawAsync(idegTarget);
+  notifyLoop();
+}
+
+void EventChassisControllerPID::turnAngleAsync(const QAngle idegTarget) {
+  SteppedChassisControllerPID::turnAngleAsync(idegTarget);
+  notifyLoop();
+}
+
+void EventChassisControllerPID::stop() {
+  SteppedChassisControllerPID::stop();
+  notifyLoop();
+}
+
+void EventChassisControllerPID::notifyLoop() {
+  if (task) {
+    pros::c::task_notify(task->thread);
+  }
+}
+
+void EventChassisControllerPID::waitIdle(AbstractRate &) {
+  // Notifications sent while a movement was running are still pending, so none are lost between
+  // the idle check and the wait.
+  pros::c::task_notify_take(true, TIMEOUT_MAX);
+}
+
+void EventChassisControllerPID::waitStep(AbstractRate &irate) {
+  // Clear notifications from this movement so they don't wake the next idle wait early.
+  pros::c::task_notify_take(true, 0);
+  irate.delayUntil(threadSleepTime);
+}
+} // namespace okapi
@@ -0,0 +1,161 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/control/util/controlExecutor.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace okapi {
+ControlExecutor::ControlExecutor(const QTime &iperiod,
+                                 const std::uint32_t ipriority,
+                                 const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    period(std::max<std::uint32_t>(1, static_cast<std::uint32_t>(iperiod.convert(millisecond)))),
+    priority(ipriority) {
+}
+
+ControlExecutor::~ControlExecutor() {
+  stop();
+}
+
+bool ControlExecutor::add(const ControlPhase iphase,
+                          const std::string &iname,
+                          std::function<void()> istep) {
+  // After a stop from a job, the last tick is still iterating the jobs until it returns.
+  if (task.isActive()) {
+    LOG_WARN("ControlExecutor: Can't add " + iname + " while running.");
+    return false;
+  }
+
+  // Keep jobs grouped by phase and in insertion order within a phase.
+  const auto pos = std::upper_bound(
+    jobs.begin(), jobs.end(), iphase, [](const ControlPhase phase, const Job &job) {
+      return phase < job.stats.phase;
+    });
+
+  ControlJobStats stats;
+  stats.name = iname;
+  stats.phase = iphase;
+  jobs.insert(pos, Job{std::move(istep), stats});
+  return true;
+}
+
+bool ControlExecutor::addController(
+  const std::string &iname,
+  const std::shared_ptr<IterativeController<double, double>> &icontroller,
+  const std::shared_ptr<ControllerInput<double>> &iinput,
+  const std::shared_ptr<ControllerOutput<double>> &ioutput) {
+  if (task.isActive()) {
+    LOG_WARN("ControlExecutor: Can't add " + iname + " while running.");
+    return false;
+  }
+
+  // The jobs of one controller hand their values to each other through this.
+  struct Signals {
+    double reading{0};
+    double output{0};
+  };
+  auto signals = std::make_shared<Signals>();
+
+  add(ControlPhase::sense, iname + " sense", [signals, iinput]() {
+    signals->reading = iinput->controllerGet();
+  });
+
+  add(ControlPhase::control, iname + " control", [signals, icontroller]() {
+    signals->output = icontroller->step(signals->reading);
+  });
+
+  add(ControlPhase::actuate, iname + " actuate", [signals, icontroller, ioutput]() {
+    if (!icontroller->isDisabled()) {
+      ioutput->controllerSet(signals->output);
+    }
+  });
+
+  return true;
+}
+
+void ControlExecutor::start() {
+  // The jobs and durations are only touched once the last tick has returned.
+  if (task.isActive()) {
+    return;
+  }
+
+  {
+    std::lock_guard<CrossplatformMutex> lock(statsMutex);
+    tickStats = ControlTickStats{};
+    for (auto &job : jobs) {
+      job.stats.lastTime = 0;
+      job.stats.maxTime = 0;
+      job.stats.meanTime = 0;
+    }
+  }
+
+  // Durations are collected without the lock and published once per tick.
+  durations.assign(jobs.size(), 0);
+
+  LOG_INFO("ControlExecutor: Starting " + std::to_string(jobs.size()) +
+           " jobs with a period of " + std::to_string(period) + " ms.");
+  task.start("ControlExecutor", period, priority, [this](std::uint32_t) { tick(); });
+}
+
+void ControlExecutor::stop() {
+  if (!isRunning()) {
+    return;
+  }
+
+  LOG_INFO_S("ControlExecutor: Stopping.");
+
+  // The task finishes its current tick so no job is cut off halfway through.
+  task.stop();
+}
+
+bool ControlExecutor::isRunning() const {
+  return task.isRunning();
+}
+
+std::vector<ControlJobStats> ControlExecutor::getJobStats() const {
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  std::vector<ControlJobStats> out;
+  out.reserve(jobs.size());
+  for (const auto &job : jobs) {
+    out.push_back(job.stats);
+  }
+  return out;
+}
+
+ControlTickStats ControlExecutor::getTickStats() const {
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  return tickStats;
+}
+
+void ControlExecutor::tick() {
+  const std::uint64_t tickStart = pros::c::micros();
+
+  std::uint64_t jobStart = tickStart;
+  for (std::size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].step();
+    const std::uint64_t jobEnd = pros::c::micros();
+    durations[i] = static_cast<std::uint32_t>(jobEnd - jobStart);
+    jobStart = jobEnd;
+  }
+
+  const auto elapsed = static_cast<std::uint32_t>(jobStart - tickStart);
+
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  tickStats.ticks++;
+  tickStats.lastTickTime = elapsed;
+  tickStats.maxTickTime = std::max(tickStats.maxTickTime, elapsed);
+  if (elapsed > period * 1000) {
+    tickStats.overruns++;
+  }
+
+  for (std::size_t i = 0; i < jobs.size(); i++) {
+    auto &stats = jobs[i].stats;
+    stats.lastTime = durations[i];
+    stats.maxTime = std::max(stats.maxTime, durations[i]);
+    stats.meanTime += (durations[i] - stats.meanTime) / tickStats.ticks;
+  }
+}
+} // namespace okapi
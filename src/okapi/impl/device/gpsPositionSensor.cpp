@@ -0,0 +1,51 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/device/gpsPositionSensor.hpp"
+#include "okapi/api/odometry/odomMath.hpp"
+#include "okapi/api/odometry/point.hpp"
+
+namespace okapi {
+GpsPositionSensor::GpsPositionSensor(const std::uint8_t iport, const QLength &imaxError)
+  : port(iport), maxError(imaxError) {
+  pros::c::gps_set_data_rate(port, dataRate);
+}
+
+PositionFix GpsPositionSensor::getFix() {
+  const std::uint32_t now = pros::millis();
+  if (now - lastFixTime < dataRate) {
+    return {};
+  }
+
+  const double error = pros::c::gps_get_error(port);
+  if (error == PROS_ERR_F || error > maxError.convert(meter)) {
+    return {};
+  }
+
+  const pros::c::gps_status_s_t status = pros::c::gps_get_status(port);
+  if (status.x == PROS_ERR_F) {
+    return {};
+  }
+
+  lastFixTime = now;
+
+  // The GPS reports in StateMode::CARTESIAN (x right, y forward). Its heading is clockwise from
+  // its y axis, which is the frame transformation's x axis, so only the position needs swapping.
+  const Point position = Point{status.x * meter, status.y * meter}.inFT(StateMode::CARTESIAN);
+  const double heading = pros::c::gps_get_heading(port);
+
+  PositionFix fix;
+  fix.valid = true;
+  fix.x = position.x;
+  fix.y = position.y;
+  fix.stdDev = error * meter;
+  fix.timestamp = now;
+  if (heading != PROS_ERR_F) {
+    fix.headingValid = true;
+    fix.heading = OdomMath::constrainAngle180(heading * degree);
+  }
+  return fix;
+}
+} // namespace okapi
@@ -0,0 +1,27 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/device/rotarysensor/timestampedIntegratedEncoder.hpp"
+
+namespace okapi {
+TimestampedIntegratedEncoder::TimestampedIntegratedEncoder(const okapi::Motor &imotor)
+  : IntegratedEncoder(imotor) {
+}
+
+TimestampedIntegratedEncoder::TimestampedIntegratedEncoder(const std::int8_t iport,
+                                                           const bool ireversed)
+  : IntegratedEncoder(iport, ireversed) {
+}
+
+TimestampedReading TimestampedIntegratedEncoder::getTimestamped() const {
+  std::uint32_t timestamp = 0;
+  const std::int32_t ticks = pros::c::motor_get_raw_position(port, &timestamp);
+  if (ticks == PROS_ERR) {
+    return {static_cast<double>(PROS_ERR), timestamp};
+  }
+
+  return {static_cast<double>(ticks) * reversed, timestamp};
+}
+} // namespace okapi
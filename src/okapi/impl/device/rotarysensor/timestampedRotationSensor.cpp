@@ -0,0 +1,25 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/device/rotarysensor/timestampedRotationSensor.hpp"
+
+namespace okapi {
+TimestampedRotationSensor::TimestampedRotationSensor(const std::uint8_t iport,
+                                                     const bool ireversed)
+  : RotationSensor(iport, ireversed) {
+  pros::c::rotation_set_data_rate(port, dataRate);
+}
+
+TimestampedReading TimestampedRotationSensor::getTimestamped() const {
+  const std::uint32_t now = pros::millis();
+  const double value = get();
+  if (value == PROS_ERR) {
+    return {value, now};
+  }
+
+  // Reads within one period get the same timestamp, so they count as the same sample.
+  return {value, now - now % dataRate};
+}
+} // namespace okapi
@@ -0,0 +1,78 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/odometry/odometryTask.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace okapi {
+OdometryTask::OdometryTask(const std::shared_ptr<Odometry> &iodometry,
+                           const QTime &iperiod,
+                           const std::uint32_t ipriority,
+                           const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    odom(iodometry),
+    period(std::max<std::uint32_t>(1, static_cast<std::uint32_t>(iperiod.convert(millisecond)))),
+    priority(ipriority) {
+}
+
+OdometryTask::~OdometryTask() {
+  stop();
+}
+
+void OdometryTask::start() {
+  if (isRunning()) {
+    return;
+  }
+
+  {
+    std::lock_guard<CrossplatformMutex> lock(statsMutex);
+    stats = OdometryStepStats{};
+  }
+
+  LOG_INFO("OdometryTask: Starting with a period of " + std::to_string(period) + " ms.");
+  task.start("OdometryTask", period, priority, [this](std::uint32_t) { step(); });
+}
+
+void OdometryTask::stop() {
+  if (!isRunning()) {
+    return;
+  }
+
+  LOG_INFO_S("OdometryTask: Stopping.");
+
+  // The task finishes its current step instead of being deleted while it may hold the stats
+  // mutex.
+  task.stop();
+}
+
+bool OdometryTask::isRunning() const {
+  return task.isRunning();
+}
+
+OdometryStepStats OdometryTask::getStepStats() const {
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  return stats;
+}
+
+std::shared_ptr<Odometry> OdometryTask::getOdometry() const {
+  return odom;
+}
+
+void OdometryTask::step() {
+  const std::uint64_t start = pros::c::micros();
+  odom->step();
+  const auto elapsed = static_cast<std::uint32_t>(pros::c::micros() - start);
+
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  stats.steps++;
+  stats.lastStepTime = elapsed;
+  stats.maxStepTime = std::max(stats.maxStepTime, elapsed);
+  stats.meanStepTime += (elapsed - stats.meanStepTime) / stats.steps;
+  if (elapsed > period * 1000) {
+    stats.overruns++;
+  }
+}
+} // namespace okapi
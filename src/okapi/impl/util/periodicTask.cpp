@@ -0,0 +1,117 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/util/periodicTask.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace okapi {
+PeriodicTask::PeriodicTask() : idle(pros::c::sem_create(1, 1)) {}
+
+PeriodicTask::~PeriodicTask() {
+  stop();
+  delete thread;
+  pros::c::sem_delete(idle);
+}
+
+bool PeriodicTask::start(const std::string &iname,
+                         const std::uint32_t iperiod,
+                         const std::uint32_t ipriority,
+                         std::function<void(std::uint32_t)> ijob,
+                         const std::uint16_t istackDepth) {
+  std::lock_guard<CrossplatformMutex> lock(stateMutex);
+
+  // Don't take the semaphore from under tasks still waiting for the previous loop.
+  if (loopActive || waiters > 0) {
+    return false;
+  }
+
+  // The previous loop gives the semaphore back just after clearing loopActive, without the lock.
+  pros::c::sem_wait(idle, TIMEOUT_MAX);
+
+  // The previous loop has returned, so its task is done.
+  delete thread;
+
+  name = iname;
+  period = std::max<std::uint32_t>(1, iperiod);
+  job = std::move(ijob);
+  loopActive = true;
+  running.store(true, std::memory_order_release);
+
+  // A task with a higher priority than this one starts at once, but it can't reach the end of the
+  // loop until the lock is released.
+  thread = new CrossplatformThread(trampoline, this, ipriority, istackDepth, name.c_str());
+  loopTask = thread->thread;
+  return true;
+}
+
+void PeriodicTask::stop() {
+  pros::task_t toWake;
+  {
+    std::lock_guard<CrossplatformMutex> lock(stateMutex);
+    running.store(false, std::memory_order_release);
+
+    // Waiting from the loop's own task would deadlock. The loop sees the flag when the job returns.
+    if (!loopActive || loopTask == pros::c::task_get_current()) {
+      return;
+    }
+
+    waiters++;
+    toWake = loopTask;
+  }
+
+  // Cut the wait for the next release short. If the job is running, the notification stays
+  // pending and the wait after it returns at once.
+  pros::c::task_notify(toWake);
+
+  // The loop gives the semaphore back once it has finished with this object. Pass it on to the
+  // next waiter.
+  pros::c::sem_wait(idle, TIMEOUT_MAX);
+  pros::c::sem_post(idle);
+
+  std::lock_guard<CrossplatformMutex> lock(stateMutex);
+  waiters--;
+}
+
+bool PeriodicTask::isRunning() const {
+  return running.load(std::memory_order_acquire);
+}
+
+bool PeriodicTask::isActive() const {
+  std::lock_guard<CrossplatformMutex> lock(stateMutex);
+  return loopActive;
+}
+
+void PeriodicTask::trampoline(void *context) {
+  if (context) {
+    static_cast<PeriodicTask *>(context)->loop();
+  }
+}
+
+void PeriodicTask::loop() {
+  std::uint32_t release = pros::millis();
+
+  while (running.load(std::memory_order_acquire)) {
+    job(release);
+
+    // Stay on the grid of releases like task_delay_until. After an overrun this is already in the
+    // past and the job runs again at once.
+    release += period;
+    for (std::uint32_t now = pros::millis();
+         running.load(std::memory_order_acquire) && static_cast<std::int32_t>(release - now) > 0;
+         now = pros::millis()) {
+      pros::c::task_notify_take(true, release - now);
+    }
+  }
+
+  {
+    std::lock_guard<CrossplatformMutex> lock(stateMutex);
+    loopActive = false;
+  }
+
+  // Nothing may touch this object from here on, because a waiter may destroy it.
+  pros::c::sem_post(idle);
+}
+} // namespace okapi
@@ -0,0 +1,197 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/util/periodicTaskSet.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace okapi {
+PeriodicTaskSet::PeriodicTaskSet(const std::uint32_t ihighestPriority,
+                                 const std::uint32_t ilowestPriority,
+                                 const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    highestPriority(std::max(ihighestPriority, ilowestPriority)),
+    lowestPriority(std::min(ihighestPriority, ilowestPriority)) {
+  missCallback = [this](const DeadlineMiss &imiss) {
+    LOG_WARN("PeriodicTaskSet: " + imiss.name + " missed its deadline of " +
+             std::to_string(imiss.deadline) + " us (finished after " +
+             std::to_string(imiss.responseTime) + " us).");
+  };
+}
+
+PeriodicTaskSet::~PeriodicTaskSet() {
+  stop();
+
+  // A job which stopped the set from its own task may still be running, and it uses the members
+  // destroyed before the entries.
+  for (auto &entry : entries) {
+    entry->task.stop();
+  }
+}
+
+bool PeriodicTaskSet::add(const std::string &iname,
+                          const QTime &iperiod,
+                          std::function<void()> ijob,
+                          const QTime &ideadline,
+                          const std::uint16_t istackDepth) {
+  if (isRunning()) {
+    LOG_WARN("PeriodicTaskSet: Can't add " + iname + " while running.");
+    return false;
+  }
+
+  const auto period =
+    std::max<std::uint32_t>(1, static_cast<std::uint32_t>(iperiod.convert(millisecond)));
+  const auto deadline = static_cast<std::uint32_t>(ideadline.convert(millisecond) * 1000);
+
+  auto entry = std::make_unique<Entry>();
+  entry->job = std::move(ijob);
+  entry->deadline = deadline > 0 ? deadline : period * 1000;
+  entry->stackDepth = istackDepth;
+  entry->stats.name = iname;
+  entry->stats.period = period;
+  entries.push_back(std::move(entry));
+  return true;
+}
+
+void PeriodicTaskSet::onDeadlineMiss(std::function<void(const DeadlineMiss &)> icallback) {
+  missCallback = std::move(icallback);
+}
+
+void PeriodicTaskSet::start() {
+  if (running.exchange(true)) {
+    return;
+  }
+
+  const double utilization = getUtilization();
+  if (utilization > utilizationBound(entries.size())) {
+    LOG_WARN("PeriodicTaskSet: The last run's utilization " + std::to_string(utilization) +
+             " is above the rate-monotonic bound " +
+             std::to_string(utilizationBound(entries.size())) + ".");
+  }
+
+  // Rate-monotonic: shorter periods get higher priorities.
+  std::vector<Entry *> byPeriod;
+  for (auto &entry : entries) {
+    byPeriod.push_back(entry.get());
+  }
+  std::stable_sort(byPeriod.begin(), byPeriod.end(), [](const Entry *a, const Entry *b) {
+    return a->stats.period < b->stats.period;
+  });
+
+  std::uint32_t priority = highestPriority;
+  for (std::size_t i = 0; i < byPeriod.size(); i++) {
+    if (i > 0 && byPeriod[i]->stats.period != byPeriod[i - 1]->stats.period &&
+        priority > lowestPriority) {
+      priority--;
+    }
+
+    const std::string name = byPeriod[i]->stats.name;
+    const std::uint32_t period = byPeriod[i]->stats.period;
+    {
+      std::lock_guard<CrossplatformMutex> lock(statsMutex);
+      byPeriod[i]->stats = PeriodicTaskStats{};
+      byPeriod[i]->stats.name = name;
+      byPeriod[i]->stats.period = period;
+      byPeriod[i]->stats.priority = priority;
+    }
+  }
+
+  for (auto *entry : byPeriod) {
+    LOG_INFO("PeriodicTaskSet: Starting " + entry->stats.name + " every " +
+             std::to_string(entry->stats.period) + " ms at priority " +
+             std::to_string(entry->stats.priority) + ".");
+    entry->task.start(
+      entry->stats.name,
+      entry->stats.period,
+      entry->stats.priority,
+      [this, entry](const std::uint32_t irelease) { runJob(*entry, irelease); },
+      entry->stackDepth);
+  }
+}
+
+void PeriodicTaskSet::stop() {
+  if (!running.exchange(false)) {
+    return;
+  }
+
+  LOG_INFO_S("PeriodicTaskSet: Stopping.");
+
+  for (auto &entry : entries) {
+    entry->task.stop();
+  }
+}
+
+bool PeriodicTaskSet::isRunning() const {
+  return running.load(std::memory_order_acquire);
+}
+
+std::vector<PeriodicTaskStats> PeriodicTaskSet::getStats() const {
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  std::vector<PeriodicTaskStats> out;
+  out.reserve(entries.size());
+  for (const auto &entry : entries) {
+    out.push_back(entry->stats);
+  }
+  return out;
+}
+
+double PeriodicTaskSet::getUtilization() const {
+  std::lock_guard<CrossplatformMutex> lock(statsMutex);
+  double utilization = 0;
+  for (const auto &entry : entries) {
+    utilization += entry->stats.meanExecTime / (entry->stats.period * 1000.0);
+  }
+  return utilization;
+}
+
+double PeriodicTaskSet::utilizationBound(const std::size_t inumTasks) {
+  if (inumTasks == 0) {
+    return 1;
+  }
+
+  const auto n = static_cast<double>(inumTasks);
+  return n * (std::pow(2.0, 1.0 / n) - 1);
+}
+
+void PeriodicTaskSet::runJob(Entry &ientry, const std::uint32_t irelease) {
+  const std::uint64_t releaseMicros = static_cast<std::uint64_t>(irelease) * 1000;
+  const std::uint64_t start = pros::c::micros();
+  ientry.job();
+  const std::uint64_t end = pros::c::micros();
+
+  const auto jitter = static_cast<std::uint32_t>(start > releaseMicros ? start - releaseMicros : 0);
+  const auto exec = static_cast<std::uint32_t>(end - start);
+  const auto response = static_cast<std::uint32_t>(end > releaseMicros ? end - releaseMicros : 0);
+  const bool missed = response > ientry.deadline;
+
+  {
+    std::lock_guard<CrossplatformMutex> lock(statsMutex);
+    auto &stats = ientry.stats;
+    stats.runs++;
+    stats.maxExecTime = std::max(stats.maxExecTime, exec);
+    stats.meanExecTime += (exec - stats.meanExecTime) / stats.runs;
+    stats.maxJitter = std::max(stats.maxJitter, jitter);
+    stats.execHistogram[bucket(exec)]++;
+    stats.jitterHistogram[bucket(jitter)]++;
+    if (missed) {
+      stats.deadlineMisses++;
+    }
+  }
+
+  if (missed && missCallback) {
+    missCallback({ientry.stats.name, releaseMicros, response, ientry.deadline});
+  }
+}
+
+std::size_t PeriodicTaskSet::bucket(std::uint32_t iduration) {
+  std::size_t out = 0;
+  while (iduration > 1 && out < PeriodicTaskStats::buckets - 1) {
+    iduration >>= 1;
+    out++;
+  }
+  return out;
+}
+} // namespace okapi
@@ -0,0 +1,47 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/util/predictiveTimeUtilFactory.hpp"
+#include "okapi/api/control/util/predictiveSettledUtil.hpp"
+#include "okapi/impl/util/rate.hpp"
+#include "okapi/impl/util/timer.hpp"
+
+namespace okapi {
+PredictiveTimeUtilFactory::PredictiveTimeUtilFactory(const double iatTargetError,
+                                                     const double iatTargetDerivative,
+                                                     const QTime &iatTargetTime,
+                                                     const QTime &ipredictionHorizon,
+                                                     const double icaptureError)
+  : atTargetError(iatTargetError),
+    atTargetDerivative(iatTargetDerivative),
+    atTargetTime(iatTargetTime),
+    predictionHorizon(ipredictionHorizon),
+    captureError(icaptureError) {
+}
+
+TimeUtil PredictiveTimeUtilFactory::create() {
+  return withPredictiveSettledUtilParams(
+    atTargetError, atTargetDerivative, atTargetTime, predictionHorizon, captureError);
+}
+
+TimeUtil PredictiveTimeUtilFactory::withPredictiveSettledUtilParams(
+  const double iatTargetError,
+  const double iatTargetDerivative,
+  const QTime &iatTargetTime,
+  const QTime &ipredictionHorizon,
+  const double icaptureError) {
+  return TimeUtil(
+    Supplier<std::unique_ptr<AbstractTimer>>([]() { return std::make_unique<Timer>(); }),
+    Supplier<std::unique_ptr<AbstractRate>>([]() { return std::make_unique<Rate>(); }),
+    Supplier<std::unique_ptr<SettledUtil>>([=]() {
+      return std::make_unique<PredictiveSettledUtil>(std::make_unique<Timer>(),
+                                                     iatTargetError,
+                                                     iatTargetDerivative,
+                                                     iatTargetTime,
+                                                     ipredictionHorizon,
+                                                     icaptureError);
+    }));
+}
+} // namespace okapi
@@ -0,0 +1,237 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/util/taskMonitor.hpp"
+#include "pros/apix.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+extern "C" {
+/**
+ * FreeRTOS's TaskStatus_t on the 32-bit ARM port.
+ */
+typedef struct {
+  void *xHandle;
+  const char *pcTaskName;
+  unsigned long xTaskNumber;
+  int eCurrentState;
+  unsigned long uxCurrentPriority;
+  unsigned long uxBasePriority;
+  uint32_t ulRunTimeCounter;
+  void *pxStackBase;
+  uint16_t usStackHighWaterMark;
+} okapi_rtos_task_status_t;
+
+unsigned long uxTaskGetSystemState(okapi_rtos_task_status_t *pxTaskStatusArray,
+                                   unsigned long uxArraySize,
+                                   uint32_t *pulTotalRunTime) __attribute__((weak));
+
+unsigned long uxTaskGetStackHighWaterMark(void *xTask) __attribute__((weak));
+}
+
+namespace okapi {
+namespace {
+char stateChar(const pros::task_state_e_t istate) {
+  switch (istate) {
+  case pros::E_TASK_STATE_RUNNING:
+    return 'R';
+  case pros::E_TASK_STATE_READY:
+    return 'r';
+  case pros::E_TASK_STATE_BLOCKED:
+    return 'B';
+  case pros::E_TASK_STATE_SUSPENDED:
+    return 'S';
+  case pros::E_TASK_STATE_DELETED:
+    return 'D';
+  default:
+    return '?';
+  }
+}
+
+int cpuPercent(const double icpu) {
+  return icpu < 0 ? -1 : static_cast<int>(icpu * 100 + 0.5);
+}
+} // namespace
+
+TaskMonitor::TaskMonitor(const std::shared_ptr<Logger> &ilogger) : logger(ilogger) {
+  for (const char *name : {"User Initialization (PROS)",
+                           "User Comp. Init. (PROS)",
+                           "User Autonomous (PROS)",
+                           "User Operator Control (PROS)",
+                           "User Disabled (PROS)",
+                           "PROS System Daemon"}) {
+    watch(name);
+  }
+}
+
+TaskMonitor::~TaskMonitor() {
+  stop();
+}
+
+void TaskMonitor::watch(const std::string &iname, const std::uint32_t istackDepth) {
+  std::lock_guard<CrossplatformMutex> lock(samplesMutex);
+  for (auto &entry : watched) {
+    if (entry.name == iname) {
+      entry.stackDepth = istackDepth;
+      return;
+    }
+  }
+
+  watched.push_back({iname, istackDepth});
+}
+
+std::vector<TaskSample> TaskMonitor::sample() {
+  std::vector<TaskSample> out;
+  std::uint32_t totalRunTime = 0;
+
+  std::lock_guard<CrossplatformMutex> lock(samplesMutex);
+
+  if (hasSystemState()) {
+    // Leave room for tasks created between counting and sampling.
+    std::vector<okapi_rtos_task_status_t> statuses(pros::c::task_get_count() + 4);
+    const auto found = uxTaskGetSystemState(statuses.data(), statuses.size(), &totalRunTime);
+
+    out.reserve(found);
+    for (unsigned long i = 0; i < found; i++) {
+      const auto &status = statuses[i];
+      TaskSample task;
+      task.name = status.pcTaskName ? status.pcTaskName : "";
+      task.handle = static_cast<pros::task_t>(status.xHandle);
+      task.state = static_cast<pros::task_state_e_t>(status.eCurrentState);
+      task.priority = static_cast<std::uint32_t>(status.uxCurrentPriority);
+      task.stackDepth = watchedStackDepth(task.name.c_str());
+      task.stackHighWater = status.usStackHighWaterMark;
+      task.runTime = status.ulRunTimeCounter;
+      out.push_back(task);
+    }
+  } else {
+    for (const auto &entry : watched) {
+      const auto handle = pros::c::task_get_by_name(entry.name.c_str());
+      if (!handle) {
+        continue;
+      }
+
+      TaskSample task;
+      task.name = entry.name;
+      task.handle = handle;
+      task.state = pros::c::task_get_state(handle);
+      task.priority = pros::c::task_get_priority(handle);
+      task.stackDepth = entry.stackDepth;
+      if (hasStackHighWater()) {
+        task.stackHighWater = static_cast<std::int32_t>(uxTaskGetStackHighWaterMark(handle));
+      }
+      out.push_back(task);
+    }
+  }
+
+  computeCpu(out, totalRunTime);
+  samples = out;
+  lastTotalRunTime = totalRunTime;
+  return out;
+}
+
+std::vector<TaskSample> TaskMonitor::getSamples() const {
+  std::lock_guard<CrossplatformMutex> lock(samplesMutex);
+  return samples;
+}
+
+void TaskMonitor::start(const QTime &iperiod, const std::uint32_t ipriority) {
+  if (monitorTask.isRunning()) {
+    return;
+  }
+
+  if (!hasSystemState()) {
+    LOG_INFO_S("TaskMonitor: uxTaskGetSystemState is not available, only watched tasks will be "
+               "sampled and CPU use is unknown.");
+  }
+
+  if (monitorTask.start("TaskMonitor",
+                        static_cast<std::uint32_t>(iperiod.convert(millisecond)),
+                        ipriority,
+                        [this](std::uint32_t) { sample(); })) {
+    watch("TaskMonitor");
+  }
+}
+
+void TaskMonitor::stop() {
+  monitorTask.stop();
+}
+
+void TaskMonitor::dump(FILE *ifile) const {
+  const auto latest = getSamples();
+
+  fprintf(
+    ifile, "%-32s %5s %4s %11s %11s %4s\n", "task", "state", "prio", "stack free", "depth", "cpu%");
+  for (const auto &task : latest) {
+    // Flag tasks which have come within an eighth of their stack.
+    const bool low = task.stackDepth > 0 && task.stackHighWater >= 0 &&
+                     static_cast<std::uint32_t>(task.stackHighWater) < task.stackDepth / 8;
+
+    fprintf(ifile, "%-32.32s %5c %4lu %11ld %11lu %4d%s\n", task.name.c_str(),
+            stateChar(task.state), static_cast<unsigned long>(task.priority),
+            static_cast<long>(task.stackHighWater), static_cast<unsigned long>(task.stackDepth),
+            cpuPercent(task.cpu), low ? " LOW STACK" : "");
+  }
+  fflush(ifile);
+}
+
+void TaskMonitor::printPage(const std::size_t ipage) const {
+  const auto latest = getSamples();
+  const std::size_t pages =
+    std::max<std::size_t>(1, (latest.size() + tasksPerPage - 1) / tasksPerPage);
+  const std::size_t page = ipage % pages;
+
+  pros::lcd::print(0, "Tasks %u/%u   st prio free cpu%%", static_cast<unsigned>(page + 1),
+                   static_cast<unsigned>(pages));
+
+  for (std::size_t line = 0; line < tasksPerPage; line++) {
+    const std::size_t i = page * tasksPerPage + line;
+    if (i < latest.size()) {
+      const auto &task = latest[i];
+      pros::lcd::print(static_cast<std::int16_t>(line + 1), "%-16.16s %c %2lu %5ld %3d",
+                       task.name.c_str(), stateChar(task.state),
+                       static_cast<unsigned long>(task.priority),
+                       static_cast<long>(task.stackHighWater), cpuPercent(task.cpu));
+    } else {
+      pros::lcd::clear_line(static_cast<std::int16_t>(line + 1));
+    }
+  }
+}
+
+bool TaskMonitor::hasSystemState() {
+  return uxTaskGetSystemState != nullptr;
+}
+
+bool TaskMonitor::hasStackHighWater() {
+  return uxTaskGetStackHighWaterMark != nullptr;
+}
+
+std::uint32_t TaskMonitor::watchedStackDepth(const char *iname) const {
+  for (const auto &entry : watched) {
+    if (std::strcmp(entry.name.c_str(), iname) == 0) {
+      return entry.stackDepth;
+    }
+  }
+  return 0;
+}
+
+void TaskMonitor::computeCpu(std::vector<TaskSample> &isamples,
+                             const std::uint32_t itotalRunTime) const {
+  const std::uint32_t elapsed = itotalRunTime - lastTotalRunTime;
+  if (itotalRunTime == 0 || lastTotalRunTime == 0 || elapsed == 0) {
+    return;
+  }
+
+  for (auto &task : isamples) {
+    for (const auto &previous : samples) {
+      if (previous.handle == task.handle) {
+        task.cpu = static_cast<double>(task.runTime - previous.runTime) / elapsed;
+        break;
+      }
+    }
+  }
+}
+} // namespace okapi
@@ -0,0 +1,183 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/impl/util/taskWatchdog.hpp"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace okapi {
+TaskWatchdog::TaskWatchdog(const QTime &icheckPeriod,
+                           const std::uint32_t ipriority,
+                           const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    checkPeriod(
+      std::max<std::uint32_t>(1, static_cast<std::uint32_t>(icheckPeriod.convert(millisecond)))),
+    priority(ipriority) {
+}
+
+TaskWatchdog::~TaskWatchdog() {
+  stop();
+}
+
+std::size_t TaskWatchdog::registerTask(const std::string &iname,
+                                       const QTime &itimeout,
+                                       std::function<void()> isafeState,
+                                       const bool isuspend) {
+  std::lock_guard<CrossplatformMutex> lock(mutex);
+
+  const std::size_t count = entryCount.load(std::memory_order_acquire);
+  std::size_t id = count;
+  for (std::size_t i = 0; i < count; i++) {
+    if (entries[i].name == iname) {
+      id = i;
+      break;
+    }
+  }
+
+  if (id == maxTasks) {
+    std::string msg = "TaskWatchdog: Can't register " + iname + ", " +
+                      std::to_string(maxTasks) + " tasks are already registered.";
+    LOG_ERROR(msg);
+    throw std::out_of_range(msg);
+  }
+
+  auto &entry = entries[id];
+  entry.name = iname;
+  entry.task = pros::c::task_get_current();
+  entry.timeout = static_cast<std::uint32_t>(itimeout.convert(millisecond));
+  entry.safeState = std::move(isafeState);
+  entry.suspend = isuspend;
+  entry.lastBeat.store(pros::millis(), std::memory_order_relaxed);
+  entry.faulted.store(false, std::memory_order_release);
+  entry.enabled.store(true, std::memory_order_release);
+
+  if (id == count) {
+    entryCount.store(count + 1, std::memory_order_release);
+  }
+
+  const auto timeout = entry.timeout;
+  LOG_INFO("TaskWatchdog: Watching " + iname + " with a timeout of " + std::to_string(timeout) +
+           " ms");
+  return id;
+}
+
+void TaskWatchdog::disable(const std::size_t iid) {
+  if (iid < maxTasks) {
+    entries[iid].enabled.store(false, std::memory_order_release);
+  }
+}
+
+void TaskWatchdog::enable(const std::size_t iid) {
+  if (iid < maxTasks) {
+    entries[iid].lastBeat.store(pros::millis(), std::memory_order_relaxed);
+    entries[iid].faulted.store(false, std::memory_order_release);
+    entries[iid].enabled.store(true, std::memory_order_release);
+  }
+}
+
+bool TaskWatchdog::isFaulted(const std::size_t iid) const {
+  return iid < maxTasks && entries[iid].faulted.load(std::memory_order_acquire);
+}
+
+std::vector<WatchdogFault> TaskWatchdog::getFaults() const {
+  std::lock_guard<CrossplatformMutex> lock(mutex);
+
+  const std::size_t stored = std::min<std::size_t>(faultCount, maxFaults);
+  const std::size_t oldest = faultCount > maxFaults ? faultCount % maxFaults : 0;
+
+  std::vector<WatchdogFault> out;
+  out.reserve(stored);
+  for (std::size_t i = 0; i < stored; i++) {
+    out.push_back(faults[(oldest + i) % maxFaults]);
+  }
+  return out;
+}
+
+std::uint32_t TaskWatchdog::getFaultCount() const {
+  std::lock_guard<CrossplatformMutex> lock(mutex);
+  return faultCount;
+}
+
+void TaskWatchdog::start() {
+  task.start("TaskWatchdog", checkPeriod, priority, [this](std::uint32_t) { checkAll(); });
+}
+
+void TaskWatchdog::stop() {
+  task.stop();
+}
+
+std::function<void()> TaskWatchdog::stopMotors(std::vector<pros::Motor> imotors,
+                                               const pros::motor_brake_mode_e_t ibrakeMode) {
+  return [motors = std::move(imotors), ibrakeMode]() {
+    for (const auto &motor : motors) {
+      motor.set_brake_mode(ibrakeMode);
+      motor.brake();
+    }
+  };
+}
+
+std::function<void()>
+TaskWatchdog::stopMotors(std::vector<std::shared_ptr<AbstractMotor>> imotors,
+                         const AbstractMotor::brakeMode ibrakeMode) {
+  return [motors = std::move(imotors), ibrakeMode]() {
+    for (const auto &motor : motors) {
+      motor->setBrakeMode(ibrakeMode);
+      motor->moveVelocity(0);
+    }
+  };
+}
+
+void TaskWatchdog::check(Entry &ientry, const std::uint32_t inow) {
+  if (!ientry.enabled.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  // A check-in after inow was read makes this negative, which is not a miss.
+  const auto silence =
+    static_cast<std::int32_t>(inow - ientry.lastBeat.load(std::memory_order_relaxed));
+
+  if (silence <= static_cast<std::int32_t>(ientry.timeout)) {
+    if (ientry.faulted.exchange(false, std::memory_order_acq_rel)) {
+      const std::string msg = "TaskWatchdog: " + ientry.name + " checked in again.";
+      LOG_WARN(msg);
+    }
+    return;
+  }
+
+  if (ientry.faulted.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  // Suspend first so a wedged loop can't overwrite the safe state.
+  if (ientry.suspend && ientry.task &&
+      pros::c::task_get_state(ientry.task) != pros::E_TASK_STATE_DELETED) {
+    pros::c::task_suspend(ientry.task);
+  }
+
+  if (ientry.safeState) {
+    ientry.safeState();
+  }
+
+  faults[faultCount % maxFaults] = {
+    ientry.name, inow, static_cast<std::uint32_t>(silence), ientry.timeout};
+  faultCount++;
+
+  const std::string msg = "TaskWatchdog: " + ientry.name + " missed its heartbeat (silent for " +
+                          std::to_string(silence) + " ms, timeout " +
+                          std::to_string(ientry.timeout) +
+                          " ms). Its motors were put in their safe state.";
+  LOG_ERROR(msg);
+}
+
+void TaskWatchdog::checkAll() {
+  std::lock_guard<CrossplatformMutex> lock(mutex);
+  const std::uint32_t time = pros::millis();
+  const std::size_t count = entryCount.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < count; i++) {
+    check(entries[i], time);
+  }
+}
+} // namespace okapi